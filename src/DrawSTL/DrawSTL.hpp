@@ -11,31 +11,10 @@ class DrawSTL
 private:
 
 public:
-    static float GetLowestPoint(Model &model){
-        float lowest = 0.0f;
-        for (int i = 0; i < model.meshes[0].vertices.size(); i+=3){
-            if (model.meshes[0].vertices[i+1].Position.z < lowest){
-                lowest = model.meshes[0].vertices[i+1].Position.z;
-            }
-        }
-        return lowest;
-    }
-
-    static glm::vec3 GetXYCenterPoint(Model &model){
-        glm::vec3 center = glm::vec3(0.0f, 0.0f, 0.0f);
-        for (int i = 0; i < model.meshes[0].vertices.size(); i+=3){
-            center.x += model.meshes[0].vertices[i+1].Position.x;
-            center.y += model.meshes[0].vertices[i+1].Position.y;
-        }
-        center.x /= model.meshes[0].vertices.size()/3;
-        center.y /= model.meshes[0].vertices.size()/3;
-        return center;
-    }
-
-    static void Draw(Shader objectShader, Model ourModel,  glm::mat4 view, glm::mat4 projection, Camera camera, glm::vec3 lowest);
+    static void Draw(Shader objectShader, Model ourModel,  glm::mat4 view, glm::mat4 projection, Camera camera, glm::mat4 transform = glm::mat4(1.0f));
 };
 
-void DrawSTL::Draw(Shader objectShader, Model ourModel,  glm::mat4 view, glm::mat4 projection, Camera camera, glm::vec3 lowest){
+void DrawSTL::Draw(Shader objectShader, Model ourModel,  glm::mat4 view, glm::mat4 projection, Camera camera, glm::mat4 transform){
     objectShader.use();
 
     // light properties
@@ -52,8 +31,8 @@ void DrawSTL::Draw(Shader objectShader, Model ourModel,  glm::mat4 view, glm::ma
     glm::mat4 model = glm::mat4(1.0f);
     model = glm::translate(model, glm::vec3(0.0f, 0.0f, 0.0f)); // translate it down so it's at the center of the scene
     model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-    model = glm::translate(model, lowest*-0.1f); // translate it down so it's at the center of the scene
     model = glm::scale(model, glm::vec3(0.1f, 0.1f, 0.1f));	// it's a bit too big for our scene, so scale it down
+    model = model * transform; // the transform of the object in mm, it puts the loaded vertices in place on the plate
     objectShader.setMat4("model", model);
 
     ourModel.Draw(objectShader);
@@ -16,7 +16,7 @@ private:
     void SetupBuffers();
     void UpdateBuffers(vector<float> &vertices);
     void Draw(Shader &shader, int amountOfLines, float aspectRatio = 1.0f, glm::vec3 color = glm::vec3(1.0f, 1.0f, 1.0f));
-    vector<float> GetVertices(Clipper2Lib::PathsD &paths, float buildplateSize);
+    vector<float> GetVertices(Clipper2Lib::PathsD &paths, float buildplateSize, bool closed = true);
 
     unsigned int VBO, VAO;
     Clipper2Lib::PathsD lines;
@@ -61,12 +61,22 @@ void Intersection::DrawIntersection(float aspectRatio, SlicerSettings settings)
         return;
     }
     vector<float> outerWall = GetVertices(sliceMap[plane].outerWall, settings.GetBuildVolume().x);
-    if (outerWall.size() <= 0)
+    if (outerWall.size() > 0)
 	{
-		return;
+        UpdateBuffers(outerWall);
+        Draw(intersectionShader, outerWall.size()/2, aspectRatio, glm::vec3(1.0f, 0.0f, 0.0f));
+    }
+
+    Clipper2Lib::PathsD thinWallPaths;
+    for (int i = 0; i < sliceMap[plane].thinWalls.size(); i++)
+    {
+        thinWallPaths.push_back(sliceMap[plane].thinWalls[i].path);
+    }
+    vector<float> thinWalls = GetVertices(thinWallPaths, settings.GetBuildVolume().x, false);
+    if (thinWalls.size() > 0) {
+        UpdateBuffers(thinWalls);
+        Draw(intersectionShader, thinWalls.size()/2, aspectRatio, glm::vec3(1.0f, 0.0f, 0.0f));
     }
-    UpdateBuffers(outerWall);
-    Draw(intersectionShader, outerWall.size()/2, aspectRatio, glm::vec3(1.0f, 0.0f, 0.0f));
 
     for (int i = 0; i < sliceMap[plane].shells.size(); i++)
     {
@@ -79,24 +89,82 @@ void Intersection::DrawIntersection(float aspectRatio, SlicerSettings settings)
         Draw(intersectionShader, shell.size()/2, aspectRatio, glm::vec3(0.0f, 1.0f, 0.0f));
     }
 
-    vector<float> infill = GetVertices(sliceMap[plane].infill, settings.GetBuildVolume().x);
+    Clipper2Lib::PathsD partialShellPaths;
+    for (int i = 0; i < sliceMap[plane].partialShells.size(); i++)
+    {
+        partialShellPaths.push_back(sliceMap[plane].partialShells[i].path);
+    }
+    vector<float> partialShells = GetVertices(partialShellPaths, settings.GetBuildVolume().x, false);
+    if (partialShells.size() > 0) {
+        UpdateBuffers(partialShells);
+        Draw(intersectionShader, partialShells.size()/2, aspectRatio, glm::vec3(0.0f, 1.0f, 0.0f));
+    }
+
+    Clipper2Lib::PathsD gapFillPaths;
+    for (int i = 0; i < sliceMap[plane].gapFill.size(); i++)
+    {
+        gapFillPaths.push_back(sliceMap[plane].gapFill[i].path);
+    }
+    vector<float> gapFill = GetVertices(gapFillPaths, settings.GetBuildVolume().x, false);
+    if (gapFill.size() > 0) {
+        UpdateBuffers(gapFill);
+        Draw(intersectionShader, gapFill.size()/2, aspectRatio, glm::vec3(1.0f, 0.0f, 1.0f));
+    }
+
+    vector<float> infill = GetVertices(sliceMap[plane].infill, settings.GetBuildVolume().x, false);
     if (infill.size() > 0) {
         UpdateBuffers(infill);
         Draw(intersectionShader, infill.size()/2, aspectRatio, glm::vec3(1.0f, 1.0f, 0.0f));
     }
 
+    vector<float> combinedInfill = GetVertices(sliceMap[plane].combinedInfill, settings.GetBuildVolume().x, false);
+    if (combinedInfill.size() > 0) {
+        UpdateBuffers(combinedInfill);
+        Draw(intersectionShader, combinedInfill.size()/2, aspectRatio, glm::vec3(1.0f, 0.5f, 0.0f));
+    }
+
     vector<float> surfaceWall = GetVertices(sliceMap[plane].surfaceWall, settings.GetBuildVolume().x);
     if (surfaceWall.size() > 0) {
         UpdateBuffers(surfaceWall);
         Draw(intersectionShader, surfaceWall.size()/2, aspectRatio, glm::vec3(0.0f, 0.0f, 1.0f));
     }
 
-    vector<float> surface = GetVertices(sliceMap[plane].surface, settings.GetBuildVolume().x);
+    vector<float> surface = GetVertices(sliceMap[plane].surface, settings.GetBuildVolume().x, false);
     if (surface.size() > 0) {
 		UpdateBuffers(surface);
 		Draw(intersectionShader, surface.size()/2, aspectRatio, glm::vec3(0.0f, 0.0f, 1.0f));
 	}
 
+    vector<float> bridges = GetVertices(sliceMap[plane].bridges, settings.GetBuildVolume().x, false);
+    if (bridges.size() > 0) {
+        UpdateBuffers(bridges);
+        Draw(intersectionShader, bridges.size()/2, aspectRatio, glm::vec3(0.5f, 0.5f, 1.0f));
+    }
+
+    vector<float> ironing = GetVertices(sliceMap[plane].ironing, settings.GetBuildVolume().x, false);
+    if (ironing.size() > 0) {
+        UpdateBuffers(ironing);
+        Draw(intersectionShader, ironing.size()/2, aspectRatio, glm::vec3(0.8f, 0.8f, 0.8f));
+    }
+
+    vector<float> raft = GetVertices(sliceMap[plane].raft, settings.GetBuildVolume().x, false);
+    if (raft.size() > 0) {
+        UpdateBuffers(raft);
+        Draw(intersectionShader, raft.size()/2, aspectRatio, glm::vec3(0.6f, 0.4f, 0.2f));
+    }
+
+    vector<float> support = GetVertices(sliceMap[plane].support, settings.GetBuildVolume().x, false);
+    if (support.size() > 0) {
+        UpdateBuffers(support);
+        Draw(intersectionShader, support.size()/2, aspectRatio, glm::vec3(1.0f, 0.6f, 0.6f));
+    }
+
+    vector<float> supportInterface = GetVertices(sliceMap[plane].supportInterface, settings.GetBuildVolume().x, false);
+    if (supportInterface.size() > 0) {
+        UpdateBuffers(supportInterface);
+        Draw(intersectionShader, supportInterface.size()/2, aspectRatio, glm::vec3(1.0f, 0.3f, 0.3f));
+    }
+
     for (int i = 0; i < sliceMap[plane].skirt.size(); i++)
     {
         vector<float> skirt = GetVertices(sliceMap[plane].skirt[i], settings.GetBuildVolume().x);
@@ -168,7 +236,7 @@ void Intersection::SetHeight(int index)
     plane = index;
 }
 
-vector<float> Intersection::GetVertices(Clipper2Lib::PathsD &paths, float buildplateSize)
+vector<float> Intersection::GetVertices(Clipper2Lib::PathsD &paths, float buildplateSize, bool closed)
 {
     vector<float> vertices;
     for (int i = 0; i < paths.size(); i++)
@@ -182,6 +250,12 @@ vector<float> Intersection::GetVertices(Clipper2Lib::PathsD &paths, float buildp
             vertices.push_back(paths[i][j+1].y);
         }
 
+        //open paths (infill lines) are not closed
+        if (!closed)
+        {
+            continue;
+        }
+
         vertices.push_back(paths[i][paths[i].size()-1].x);
         vertices.push_back(paths[i][paths[i].size()-1].y);
         vertices.push_back(paths[i][0].x);
@@ -0,0 +1,51 @@
+#ifndef MESHBOUNDS_H
+#define MESHBOUNDS_H
+
+#include <vector>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "Mesh.hpp"
+
+struct Bounds
+{
+    glm::vec3 lowest;
+    glm::vec3 highest;
+};
+
+// exact bounds of a mesh after its transform, the vertices themselves are never rewritten
+class MeshBounds
+{
+public:
+    static Bounds Calculate(const vector<Vertex> &vertices, const glm::mat4 &transform = glm::mat4(1.0f));
+    static glm::mat4 PlaceOnBed(const vector<Vertex> &vertices, const glm::mat4 &transform = glm::mat4(1.0f));
+};
+
+Bounds MeshBounds::Calculate(const vector<Vertex> &vertices, const glm::mat4 &transform)
+{
+    // one parallel reduction over every vertex
+    float minX = INFINITY, minY = INFINITY, minZ = INFINITY;
+    float maxX = -INFINITY, maxY = -INFINITY, maxZ = -INFINITY;
+    #pragma omp parallel for reduction(min:minX, minY, minZ) reduction(max:maxX, maxY, maxZ)
+    for (int i = 0; i < vertices.size(); i++)
+    {
+        glm::vec3 position = glm::vec3(transform * glm::vec4(vertices[i].Position, 1.0f));
+        minX = std::min(minX, position.x);
+        minY = std::min(minY, position.y);
+        minZ = std::min(minZ, position.z);
+        maxX = std::max(maxX, position.x);
+        maxY = std::max(maxY, position.y);
+        maxZ = std::max(maxZ, position.z);
+    }
+    return {glm::vec3(minX, minY, minZ), glm::vec3(maxX, maxY, maxZ)};
+}
+
+glm::mat4 MeshBounds::PlaceOnBed(const vector<Vertex> &vertices, const glm::mat4 &transform)
+{
+    // extends the transform so the mesh rests on the bed with its bounding box centered
+    Bounds bounds = Calculate(vertices, transform);
+    glm::vec3 shift((bounds.lowest.x + bounds.highest.x) / 2, (bounds.lowest.y + bounds.highest.y) / 2, bounds.lowest.z);
+    return glm::translate(glm::mat4(1.0f), -shift) * transform;
+}
+
+#endif
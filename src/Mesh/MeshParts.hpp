@@ -0,0 +1,156 @@
+#ifndef MESHPARTS_H
+#define MESHPARTS_H
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+#include "Mesh.hpp"
+
+// splits a triangle soup in the bodies it is made of, two triangles belong to the same body when they share a corner
+// the corners of neighbouring triangles are separate vertices in the soup, they are welded by position first
+class MeshParts
+{
+private:
+    static constexpr double weldDistance = 1e-4; //corners closer than this grid are the same point, in mm
+
+    static int Find(vector<int> &parents, int vertex);
+
+public:
+    static vector<vector<Vertex>> Split(const vector<Vertex> &vertices);
+};
+
+vector<vector<Vertex>> MeshParts::Split(const vector<Vertex> &vertices)
+{
+    int n = vertices.size() / 3 * 3;
+    if (n == 0)
+    {
+        return vector<vector<Vertex>>();
+    }
+
+    // weld: sort the corners by their position on the grid, equal neighbours get the same id
+    vector<tuple<int64_t, int64_t, int64_t>> keys(n);
+    #pragma omp parallel for
+    for (int v = 0; v < n; v++)
+    {
+        glm::vec3 position = vertices[v].Position;
+        keys[v] = make_tuple((int64_t)llround(position.x / weldDistance), (int64_t)llround(position.y / weldDistance), (int64_t)llround(position.z / weldDistance));
+    }
+    vector<int> order(n);
+    iota(order.begin(), order.end(), 0);
+    sort(order.begin(), order.end(), [&keys](int a, int b) {
+        return keys[a] < keys[b];
+    });
+    vector<int> ids(n);
+    int welded = 0;
+    for (int k = 0; k < n; k++)
+    {
+        if (k > 0 && keys[order[k]] != keys[order[k - 1]])
+        {
+            welded++;
+        }
+        ids[order[k]] = welded;
+    }
+
+    // union find over the welded corners, every triangle joins its three corners
+    vector<int> parents(welded + 1);
+    iota(parents.begin(), parents.end(), 0);
+    for (int t = 0; t < n / 3; t++)
+    {
+        int a = Find(parents, ids[t * 3]);
+        for (int k = 1; k < 3; k++)
+        {
+            int b = Find(parents, ids[t * 3 + k]);
+            if (a != b)
+            {
+                parents[b] = a;
+            }
+        }
+    }
+
+    // bodies are numbered in the order their first triangle appears in the file
+    vector<int> bodies(welded + 1, -1);
+    vector<vector<Vertex>> parts;
+    for (int t = 0; t < n / 3; t++)
+    {
+        int root = Find(parents, ids[t * 3]);
+        if (bodies[root] == -1)
+        {
+            bodies[root] = parts.size();
+            parts.push_back(vector<Vertex>());
+        }
+        vector<Vertex> &part = parts[bodies[root]];
+        part.insert(part.end(), vertices.begin() + t * 3, vertices.begin() + t * 3 + 3);
+    }
+
+    // bodies whose bounds overlap are kept together: a body inside another one can be the wall of a cavity,
+    // and shells that are sunk into each other are printed as one part, sliced on their own they would print over each other
+    vector<glm::vec3> lowest(parts.size(), glm::vec3(INFINITY));
+    vector<glm::vec3> highest(parts.size(), glm::vec3(-INFINITY));
+    #pragma omp parallel for
+    for (int p = 0; p < parts.size(); p++)
+    {
+        for (Vertex &vertex : parts[p])
+        {
+            lowest[p] = glm::min(lowest[p], vertex.Position);
+            highest[p] = glm::max(highest[p], vertex.Position);
+        }
+    }
+
+    // sweep over x: only the bodies that start before another one ends along x can overlap it
+    vector<int> byX(parts.size());
+    iota(byX.begin(), byX.end(), 0);
+    sort(byX.begin(), byX.end(), [&lowest](int a, int b) {
+        return lowest[a].x < lowest[b].x;
+    });
+    vector<int> groups(parts.size());
+    iota(groups.begin(), groups.end(), 0);
+    for (int k = 0; k < byX.size(); k++)
+    {
+        int p = byX[k];
+        for (int j = k + 1; j < byX.size() && lowest[byX[j]].x <= highest[p].x; j++)
+        {
+            int q = byX[j];
+            if (glm::all(glm::lessThanEqual(lowest[q], highest[p])) && glm::all(glm::lessThanEqual(lowest[p], highest[q])))
+            {
+                int a = Find(groups, p);
+                int b = Find(groups, q);
+                if (a != b)
+                {
+                    groups[max(a, b)] = min(a, b);
+                }
+            }
+        }
+    }
+
+    // the group keeps the place of its first body in the file
+    vector<vector<Vertex>> bodyParts;
+    vector<int> merged(parts.size(), -1);
+    for (int p = 0; p < parts.size(); p++)
+    {
+        int group = Find(groups, p);
+        if (merged[group] == -1)
+        {
+            merged[group] = bodyParts.size();
+            bodyParts.push_back(vector<Vertex>());
+        }
+        vector<Vertex> &body = bodyParts[merged[group]];
+        body.insert(body.end(), parts[p].begin(), parts[p].end());
+    }
+    return bodyParts;
+}
+
+int MeshParts::Find(vector<int> &parents, int vertex)
+{
+    // path halving keeps the trees flat
+    while (parents[vertex] != vertex)
+    {
+        parents[vertex] = parents[parents[vertex]];
+        vertex = parents[vertex];
+    }
+    return vertex;
+}
+
+#endif
@@ -0,0 +1,211 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "clipper2/clipper.h"
+
+// orders parallel surface lines so every line is printed after the neighbouring lines on the side the sweep comes from,
+// neighbouring lines are always laid down in the same order, which avoids ridges where a line is pressed against a line printed later
+// lines that follow each other without choice are grouped into chains, only the order of the chains is searched
+class MonotonicOrder
+{
+private:
+    struct Line
+    {
+        int index;      // index into the input lines
+        double sweep;   // position across the lines, the sweep goes from low to high
+        double start;   // extent along the line direction
+        double end;
+    };
+
+    static void AppendLine(Clipper2Lib::PathsD &result, Clipper2Lib::PathD &line, Clipper2Lib::PointD &nozzle);
+    static double Distance(Clipper2Lib::PointD a, Clipper2Lib::PointD b) { return sqrt(pow(a.x - b.x, 2) + pow(a.y - b.y, 2)); }
+
+public:
+    static bool Order(Clipper2Lib::PathsD &lines, Clipper2Lib::PathsD &result, Clipper2Lib::PointD *start = nullptr);
+};
+
+bool MonotonicOrder::Order(Clipper2Lib::PathsD &lines, Clipper2Lib::PathsD &result, Clipper2Lib::PointD *start)
+{
+    result.clear();
+    if (lines.size() == 0)
+    {
+        return true;
+    }
+
+    // only straight parallel lines have a sweep direction
+    Clipper2Lib::PointD direction(0.0, 0.0);
+    for (Clipper2Lib::PathD &line : lines)
+    {
+        if (line.size() != 2)
+        {
+            return false;
+        }
+        double length = Distance(line.front(), line.back());
+        if (length > Distance(Clipper2Lib::PointD(0.0, 0.0), direction))
+        {
+            direction = Clipper2Lib::PointD(line.back().x - line.front().x, line.back().y - line.front().y);
+        }
+    }
+    double directionLength = Distance(Clipper2Lib::PointD(0.0, 0.0), direction);
+    if (directionLength == 0)
+    {
+        return false;
+    }
+    direction = Clipper2Lib::PointD(direction.x / directionLength, direction.y / directionLength);
+
+    // clipped endpoints are rounded to 0.01mm, which moves a line a little across the sweep
+    const double tolerance = 0.05;
+    vector<Line> sorted;
+    sorted.reserve(lines.size());
+    for (int i = 0; i < lines.size(); i++)
+    {
+        Clipper2Lib::PointD a = lines[i].front();
+        Clipper2Lib::PointD b = lines[i].back();
+        // how far the line drifts across the sweep, short clipped pieces are rounded to 0.01mm so this is not an angle
+        double drift = (b.x - a.x) * direction.y - (b.y - a.y) * direction.x;
+        if (abs(drift) > tolerance)
+        {
+            return false;
+        }
+
+        double along = a.x * direction.x + a.y * direction.y;
+        double alongB = b.x * direction.x + b.y * direction.y;
+        double sweep = (-(a.x + b.x) * direction.y + (a.y + b.y) * direction.x) / 2;
+        sorted.push_back({i, sweep, min(along, alongB), max(along, alongB)});
+    }
+
+    // group the lines into scans: lines on the same position across the sweep, sorted along their direction
+    sort(sorted.begin(), sorted.end(), [](const Line &a, const Line &b) {
+        return a.sweep < b.sweep;
+    });
+    vector<int> scanStarts = {0};
+    for (int i = 1; i < sorted.size(); i++)
+    {
+        if (sorted[i].sweep - sorted[i - 1].sweep > tolerance)
+        {
+            scanStarts.push_back(i);
+        }
+    }
+    scanStarts.push_back(sorted.size());
+    int scans = scanStarts.size() - 1;
+
+    // the line spacing is the smallest distance between scans, scans further apart belong to separate areas
+    double spacing = INFINITY;
+    for (int j = 1; j < scans; j++)
+    {
+        spacing = min(spacing, sorted[scanStarts[j]].sweep - sorted[scanStarts[j - 1]].sweep);
+    }
+    for (int j = 0; j < scans; j++)
+    {
+        sort(sorted.begin() + scanStarts[j], sorted.begin() + scanStarts[j + 1], [](const Line &a, const Line &b) {
+            return a.start < b.start;
+        });
+    }
+
+    // a line has to wait for every overlapping line of the previous scan
+    int n = sorted.size();
+    vector<vector<int>> successors(n);
+    vector<int> predecessorCount(n, 0);
+    for (int j = 1; j < scans; j++)
+    {
+        if (sorted[scanStarts[j]].sweep - sorted[scanStarts[j - 1]].sweep > spacing * 1.5)
+        {
+            continue;
+        }
+        int a = scanStarts[j - 1];
+        int b = scanStarts[j];
+        while (a < scanStarts[j] && b < scanStarts[j + 1])
+        {
+            if (sorted[a].start < sorted[b].end && sorted[b].start < sorted[a].end)
+            {
+                successors[a].push_back(b);
+                predecessorCount[b]++;
+            }
+            // move past the interval that ends first, it can not overlap anything further on
+            if (sorted[a].end < sorted[b].end)
+            {
+                a++;
+            }
+            else
+            {
+                b++;
+            }
+        }
+    }
+
+    // chains: a line with a single successor that has no other predecessor is always followed by that successor
+    vector<int> next(n, -1);
+    vector<bool> chainStart(n, true);
+    for (int i = 0; i < n; i++)
+    {
+        if (successors[i].size() == 1 && predecessorCount[successors[i][0]] == 1)
+        {
+            next[i] = successors[i][0];
+            chainStart[successors[i][0]] = false;
+        }
+    }
+
+    // only the first line of a chain has outside predecessors and only the last one has outside successors
+    vector<int> available;
+    for (int i = 0; i < n; i++)
+    {
+        if (chainStart[i] && predecessorCount[i] == 0)
+        {
+            available.push_back(i);
+        }
+    }
+
+    Clipper2Lib::PointD nozzle = start != nullptr ? *start : lines[sorted[available.empty() ? 0 : available[0]].index].front();
+    result.reserve(n);
+    while (available.size() > 0)
+    {
+        // continue with the ready chain that starts closest to the nozzle
+        int best = 0;
+        double bestDistance = INFINITY;
+        for (int k = 0; k < available.size(); k++)
+        {
+            Clipper2Lib::PathD &line = lines[sorted[available[k]].index];
+            double distance = min(Distance(nozzle, line.front()), Distance(nozzle, line.back()));
+            if (distance < bestDistance)
+            {
+                bestDistance = distance;
+                best = k;
+            }
+        }
+        int current = available[best];
+        available[best] = available.back();
+        available.pop_back();
+
+        int last = current;
+        for (int i = current; i != -1; i = next[i])
+        {
+            AppendLine(result, lines[sorted[i].index], nozzle);
+            last = i;
+        }
+
+        for (int successor : successors[last])
+        {
+            if (--predecessorCount[successor] == 0)
+            {
+                available.push_back(successor);
+            }
+        }
+    }
+
+    return result.size() == lines.size();
+}
+
+void MonotonicOrder::AppendLine(Clipper2Lib::PathsD &result, Clipper2Lib::PathD &line, Clipper2Lib::PointD &nozzle)
+{
+    // every line starts at the end closest to the nozzle, chains become zig-zags
+    if (Distance(nozzle, line.back()) < Distance(nozzle, line.front()))
+    {
+        result.push_back({line.back(), line.front()});
+    }
+    else
+    {
+        result.push_back(line);
+    }
+    nozzle = result.back().back();
+}
@@ -1,22 +1,35 @@
 #pragma once
 #include <vector>
 #include "../Slicing/Slicing.hpp"
+#include "SeamPlacement.hpp"
+#include "MonotonicOrder.hpp"
 #include "omp.h"
 
 class PathOptimization
 {
 private:
     vector<Slice> slices;
+    SeamMode seamMode;
+    double nozzleDiameter;
+    bool monotonicSurface;
 
     void OptimizeInfill();
     void OptimizeSurface();
+    void OptimizeAdhesion();
 
-    Clipper2Lib::PathsD SortPaths(Clipper2Lib::PathsD paths);
+    void SortPerIsland(vector<Clipper2Lib::PathsD *> &features, vector<int> &layers, bool monotonic);
+    vector<Clipper2Lib::PathsD> GroupByIsland(Clipper2Lib::PathsD &paths, vector<Clipper2Lib::RectD> &islandBounds);
+    Clipper2Lib::PathsD JoinIslands(vector<Clipper2Lib::PathsD> &groups, bool monotonic);
+    Clipper2Lib::PathsD SortPaths(Clipper2Lib::PathsD paths, Clipper2Lib::PointD *start = nullptr);
+    Clipper2Lib::PathsD SortLoops(Clipper2Lib::PathsD loops, Clipper2Lib::PointD start);
 
 public:
-    PathOptimization(vector<Slice> slices)
+    PathOptimization(vector<Slice> slices, SeamMode seamMode = SeamMode::Aligned, double nozzleDiameter = 0.4, bool monotonicSurface = false)
     {
         this->slices = slices;
+        this->seamMode = seamMode;
+        this->nozzleDiameter = nozzleDiameter;
+        this->monotonicSurface = monotonicSurface;
     }
     
     ~PathOptimization()
@@ -32,44 +45,226 @@ public:
 };
 
 void PathOptimization::OptimizePaths() {
+    OptimizeAdhesion();
     OptimizeInfill();
     OptimizeSurface();
+    // seams depend on where the infill of the layer below ends
+    SeamPlacement::PlaceSeams(slices, seamMode, nozzleDiameter);
 }
 
 void PathOptimization::OptimizeInfill() {
-    #pragma omp parallel for
+    vector<Clipper2Lib::PathsD *> features;
+    vector<int> layers;
     for (int i = 0; i < slices.size(); i++)
     {
-        Slice slice = slices[i];
-        Clipper2Lib::PathsD optimizedInfill = SortPaths(slice.infill);
-        slice.infill = optimizedInfill;
-        slices[i] = slice;
+        features.push_back(&slices[i].infill);
+        layers.push_back(i);
+        features.push_back(&slices[i].combinedInfill);
+        layers.push_back(i);
+        features.push_back(&slices[i].raft);
+        layers.push_back(i);
+        features.push_back(&slices[i].support);
+        layers.push_back(i);
+        features.push_back(&slices[i].supportInterface);
+        layers.push_back(i);
     }
+    SortPerIsland(features, layers, false);
 }
 
 void PathOptimization::OptimizeSurface() {
+    vector<Clipper2Lib::PathsD *> surfaces;
+    vector<Clipper2Lib::PathsD *> features;
+    vector<int> surfaceLayers;
+    vector<int> layers;
+    for (int i = 0; i < slices.size(); i++)
+    {
+        surfaces.push_back(&slices[i].surface);
+        surfaceLayers.push_back(i);
+        features.push_back(&slices[i].bridges);
+        layers.push_back(i);
+        features.push_back(&slices[i].ironing);
+        layers.push_back(i);
+    }
+    SortPerIsland(surfaces, surfaceLayers, monotonicSurface);
+    SortPerIsland(features, layers, false);
+}
+
+void PathOptimization::OptimizeAdhesion() {
+    // skirt and brim loops are closed, every loop starts at the point closest to where the previous one ended
+    // the purge line of the gcode header ends at the front left of the bed, so the first loop starts there
+    #pragma omp parallel for
+    for (int i = 0; i < slices.size(); i++)
+    {
+        Clipper2Lib::PathsD loops;
+        for (Clipper2Lib::PathsD &ring : slices[i].skirt)
+        {
+            loops.insert(loops.end(), ring.begin(), ring.end());
+        }
+        if (loops.size() == 0)
+        {
+            continue;
+        }
+
+        Clipper2Lib::PointD frontLeft = loops[0][0];
+        for (Clipper2Lib::PathD &loop : loops)
+        {
+            for (Clipper2Lib::PointD &point : loop)
+            {
+                if (point.x + point.y < frontLeft.x + frontLeft.y)
+                {
+                    frontLeft = point;
+                }
+            }
+        }
+        slices[i].skirt = {SortLoops(loops, frontLeft)};
+    }
+}
+
+void PathOptimization::SortPerIsland(vector<Clipper2Lib::PathsD *> &features, vector<int> &layers, bool monotonic) {
+    // the outer contours of the outer wall are the islands of a layer
+    vector<vector<Clipper2Lib::RectD>> islandBounds(slices.size());
     #pragma omp parallel for
     for (int i = 0; i < slices.size(); i++)
     {
-        Slice slice = slices[i];
-        Clipper2Lib::PathsD optimizedSurface = SortPaths(slice.surface);
-        slice.surface = optimizedSurface;
-        slices[i] = slice;
+        for (Clipper2Lib::PathD &path : slices[i].outerWall)
+        {
+            if (Clipper2Lib::IsPositive(path))
+            {
+                islandBounds[i].push_back(Clipper2Lib::GetBounds(path));
+            }
+        }
+    }
+
+    // paths are only sorted against the paths of their own island, which keeps the sorting cheap for layers with many islands
+    #pragma omp parallel for schedule(dynamic)
+    for (int f = 0; f < features.size(); f++)
+    {
+        vector<Clipper2Lib::PathsD> groups = GroupByIsland(*features[f], islandBounds[layers[f]]);
+        *features[f] = JoinIslands(groups, monotonic);
+    }
+}
+
+vector<Clipper2Lib::PathsD> PathOptimization::GroupByIsland(Clipper2Lib::PathsD &paths, vector<Clipper2Lib::RectD> &islandBounds) {
+    // a path belongs to the smallest island whose bounds contain its start, islands inside holes are smaller than the island around them
+    // paths outside every island (e.g. in thin parts) are kept in one extra group
+    vector<Clipper2Lib::PathsD> groups(islandBounds.size() + 1);
+    for (Clipper2Lib::PathD &path : paths)
+    {
+        if (path.size() == 0)
+        {
+            continue;
+        }
+        int best = islandBounds.size();
+        double bestArea = INFINITY;
+        for (int k = 0; k < islandBounds.size(); k++)
+        {
+            Clipper2Lib::RectD &bounds = islandBounds[k];
+            bool inside = path[0].x >= bounds.left && path[0].x <= bounds.right && path[0].y >= bounds.top && path[0].y <= bounds.bottom;
+            if (inside && bounds.Width() * bounds.Height() < bestArea)
+            {
+                bestArea = bounds.Width() * bounds.Height();
+                best = k;
+            }
+        }
+        groups[best].push_back(path);
+    }
+
+    groups.erase(std::remove_if(groups.begin(), groups.end(), [](const Clipper2Lib::PathsD &group) {
+        return group.size() == 0;
+        }), groups.end());
+    return groups;
+}
+
+Clipper2Lib::PathsD PathOptimization::JoinIslands(vector<Clipper2Lib::PathsD> &groups, bool monotonic) {
+    // islands are visited nearest neighbour first, starting with the first island
+    // every island is sorted starting from the path closest to where the previous island ended
+    Clipper2Lib::PathsD joined;
+    vector<bool> used(groups.size(), false);
+    for (int visited = 0; visited < groups.size(); visited++)
+    {
+        int next = -1;
+        double closestDistance = INFINITY;
+        for (int g = 0; g < groups.size() && joined.size() > 0; g++)
+        {
+            if (used[g])
+            {
+                continue;
+            }
+            Clipper2Lib::PointD end = joined.back().back();
+            for (Clipper2Lib::PathD &path : groups[g])
+            {
+                double distance = min(sqrt(pow(end.x - path.front().x, 2) + pow(end.y - path.front().y, 2)),
+                                      sqrt(pow(end.x - path.back().x, 2) + pow(end.y - path.back().y, 2)));
+                if (distance < closestDistance)
+                {
+                    closestDistance = distance;
+                    next = g;
+                }
+            }
+        }
+        if (next == -1)
+        {
+            next = 0;
+        }
+        used[next] = true;
+
+        Clipper2Lib::PointD *start = joined.size() > 0 ? &joined.back().back() : nullptr;
+        Clipper2Lib::PathsD sorted;
+        // monotonic ordering only works on straight parallel lines, anything else is sorted by distance
+        if (!monotonic || !MonotonicOrder::Order(groups[next], sorted, start))
+        {
+            sorted = SortPaths(groups[next], start);
+        }
+        joined.insert(joined.end(), sorted.begin(), sorted.end());
+    }
+    return joined;
+}
+
+Clipper2Lib::PathsD PathOptimization::SortLoops(Clipper2Lib::PathsD loops, Clipper2Lib::PointD start) {
+    Clipper2Lib::PathsD sortedLoops;
+    Clipper2Lib::PointD position = start;
+    while (loops.size() > 0){
+        // the closest point of any loop, a closed loop ends where it starts
+        int closestLoop = 0;
+        int closestPoint = 0;
+        double closestDistance = INFINITY;
+        for (int i = 0; i < loops.size(); i++){
+            for (int k = 0; k < loops[i].size(); k++){
+                double distance = sqrt(pow(position.x - loops[i][k].x, 2) + pow(position.y - loops[i][k].y, 2));
+                if (distance < closestDistance){
+                    closestDistance = distance;
+                    closestLoop = i;
+                    closestPoint = k;
+                }
+            }
+        }
+
+        Clipper2Lib::PathD loop = loops[closestLoop];
+        std::rotate(loop.begin(), loop.begin() + closestPoint, loop.end());
+        position = loop[0];
+        sortedLoops.push_back(loop);
+        loops.erase(loops.begin() + closestLoop);
     }
+    return sortedLoops;
 }
 
-Clipper2Lib::PathsD PathOptimization::SortPaths(Clipper2Lib::PathsD paths) {
-    if (paths.size() <= 1 ){
+Clipper2Lib::PathsD PathOptimization::SortPaths(Clipper2Lib::PathsD paths, Clipper2Lib::PointD *start) {
+    if (paths.size() <= 1 && start == nullptr){
         return paths;
     }
 
     Clipper2Lib::PathsD sortedPaths;
-    sortedPaths.push_back(paths[0]); // start with the first path
-    paths.erase(paths.begin());
+    if (start == nullptr){
+        sortedPaths.push_back(paths[0]); // start with the first path
+        paths.erase(paths.begin());
+    } else {
+        // start with the path closest to where the nozzle is, the loop below continues from its end
+        sortedPaths.push_back(Clipper2Lib::PathD{*start});
+    }
 
     while (paths.size() > 0){
-        // path is a vector of 2 points, start and end.
-        Clipper2Lib::PointD EndPoint = sortedPaths[sortedPaths.size()-1][1]; // endpoint is the end of the last path
+        // path is a line or a connected polyline, continue from its last point
+        Clipper2Lib::PointD EndPoint = sortedPaths[sortedPaths.size()-1].back(); // endpoint is the end of the last path
         double closestDistance = sqrt(pow(EndPoint.x - paths[0][0].x, 2) + pow(EndPoint.y - paths[0][0].y, 2));
         int closestIndex = 0;
         bool reverse = false;
@@ -104,5 +299,8 @@ Clipper2Lib::PathsD PathOptimization::SortPaths(Clipper2Lib::PathsD paths) {
         }
     }
 
+    if (start != nullptr){
+        sortedPaths.erase(sortedPaths.begin());
+    }
     return sortedPaths;
 }
\ No newline at end of file
@@ -0,0 +1,193 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "../Slicing/Slicing.hpp"
+#include "../SlicerSettings/SlicerSettings.hpp"
+
+// chooses where every closed wall starts (the z-seam) and rotates the contour to start there
+// candidates are scored on how concave the corner is (hides the seam), the distance to the seams of the layer below (aligned),
+// the distance to the nozzle (nearest) or how far to the back of the bed they are (rear)
+class SeamPlacement
+{
+private:
+    static int ChooseSeam(Clipper2Lib::PathD &path, SeamMode mode, Clipper2Lib::PathD &previousSeams, Clipper2Lib::PointD nozzle, double cornerWeight);
+    static double Concavity(Clipper2Lib::PathD &path, int index, double radius);
+    static void PlaceSeam(Clipper2Lib::PathD &path, SeamMode mode, Clipper2Lib::PathD &previousSeams, Clipper2Lib::PathD &seams, Clipper2Lib::PointD &nozzle, double cornerWeight);
+    static bool LastPosition(Slice &slice, Clipper2Lib::PointD &position);
+    static bool PositionBeforeWalls(Slice &slice, Clipper2Lib::PointD &position);
+
+public:
+    static void PlaceSeams(vector<Slice> &slices, SeamMode mode, double nozzleDiameter);
+};
+
+void SeamPlacement::PlaceSeams(vector<Slice> &slices, SeamMode mode, double nozzleDiameter)
+{
+    // a seam can move up to two line widths away from the best position to hide in a concave corner
+    double cornerWeight = nozzleDiameter * 2;
+
+    // layers depend on the seams of the layer below and on where the nozzle ended, so they are handled in order
+    // seams are aligned per kind of wall: outer wall, every shell and the surface walls each keep their own seams
+    vector<Clipper2Lib::PathD> previousSeams;
+    Clipper2Lib::PointD nozzle(0.0, 0.0);
+    for (int i = 0; i < slices.size(); i++)
+    {
+        Slice &slice = slices[i];
+        vector<Clipper2Lib::PathD> seams(slice.shells.size() + 2);
+        previousSeams.resize(seams.size());
+
+        PositionBeforeWalls(slice, nozzle);
+
+        // same order as the gcode writer: shells, outer wall, surface walls
+        for (int k = 0; k < slice.shells.size(); k++)
+        {
+            for (int j = 0; j < slice.shells[k].size(); j++)
+            {
+                PlaceSeam(slice.shells[k][j], mode, previousSeams[k + 1], seams[k + 1], nozzle, cornerWeight);
+            }
+        }
+        for (int j = 0; j < slice.outerWall.size(); j++)
+        {
+            PlaceSeam(slice.outerWall[j], mode, previousSeams[0], seams[0], nozzle, cornerWeight);
+        }
+        for (int j = 0; j < slice.surfaceWall.size(); j++)
+        {
+            PlaceSeam(slice.surfaceWall[j], mode, previousSeams.back(), seams.back(), nozzle, cornerWeight);
+        }
+
+        LastPosition(slice, nozzle);
+        previousSeams = seams;
+    }
+}
+
+void SeamPlacement::PlaceSeam(Clipper2Lib::PathD &path, SeamMode mode, Clipper2Lib::PathD &previousSeams, Clipper2Lib::PathD &seams, Clipper2Lib::PointD &nozzle, double cornerWeight)
+{
+    if (path.size() < 3)
+    {
+        return;
+    }
+
+    int seam = ChooseSeam(path, mode, previousSeams, nozzle, cornerWeight);
+    std::rotate(path.begin(), path.begin() + seam, path.end());
+
+    // a closed wall ends where it started
+    seams.push_back(path[0]);
+    nozzle = path[0];
+}
+
+int SeamPlacement::ChooseSeam(Clipper2Lib::PathD &path, SeamMode mode, Clipper2Lib::PathD &previousSeams, Clipper2Lib::PointD nozzle, double cornerWeight)
+{
+    int best = 0;
+    double bestCost = 0;
+    for (int i = 0; i < path.size(); i++)
+    {
+        double distance = 0;
+        if (mode == SeamMode::Nearest)
+        {
+            distance = sqrt(pow(path[i].x - nozzle.x, 2) + pow(path[i].y - nozzle.y, 2));
+        }
+        else if (mode == SeamMode::Aligned && previousSeams.size() > 0)
+        {
+            distance = INFINITY;
+            for (Clipper2Lib::PointD &previous : previousSeams)
+            {
+                distance = min(distance, sqrt(pow(path[i].x - previous.x, 2) + pow(path[i].y - previous.y, 2)));
+            }
+        }
+        else
+        {
+            // rear, and the first layer of aligned seams: the back of the bed is the largest y
+            distance = -path[i].y;
+        }
+
+        double cost = distance - cornerWeight * Concavity(path, i, cornerWeight / 2);
+        if (i == 0 || cost < bestCost)
+        {
+            bestCost = cost;
+            best = i;
+        }
+    }
+
+    return best;
+}
+
+double SeamPlacement::Concavity(Clipper2Lib::PathD &path, int index, double radius)
+{
+    // the corner is measured between the points at least radius away on both sides, so tiny kinks from slicing do not count as corners
+    int n = path.size();
+    Clipper2Lib::PointD current = path[index];
+    int previousIndex = (index + n - 1) % n;
+    while (previousIndex != index && sqrt(pow(path[previousIndex].x - current.x, 2) + pow(path[previousIndex].y - current.y, 2)) < radius)
+    {
+        previousIndex = (previousIndex + n - 1) % n;
+    }
+    int nextIndex = (index + 1) % n;
+    while (nextIndex != previousIndex && sqrt(pow(path[nextIndex].x - current.x, 2) + pow(path[nextIndex].y - current.y, 2)) < radius)
+    {
+        nextIndex = (nextIndex + 1) % n;
+    }
+    Clipper2Lib::PointD previous = path[previousIndex];
+    Clipper2Lib::PointD next = path[nextIndex];
+
+    // outer contours are counter clockwise and holes clockwise, the material is on the left of both so a right turn is a concave corner
+    double cross = (current.x - previous.x) * (next.y - current.y) - (current.y - previous.y) * (next.x - current.x);
+    double dot = (current.x - previous.x) * (next.x - current.x) + (current.y - previous.y) * (next.y - current.y);
+    double turn = atan2(cross, dot);
+
+    // 0 for straight or convex corners, 1 for a full turn back
+    return max(0.0, -turn) / M_PI;
+}
+
+bool SeamPlacement::LastPosition(Slice &slice, Clipper2Lib::PointD &position)
+{
+    // the last feature the gcode writer prints on this layer, going back from the last one it prints
+    vector<Clipper2Lib::PathsD *> features = {&slice.ironing, &slice.combinedInfill, &slice.infill, &slice.bridges, &slice.surface};
+    for (Clipper2Lib::PathsD *feature : features)
+    {
+        if (feature->size() > 0 && feature->back().size() > 0)
+        {
+            position = feature->back().back();
+            return true;
+        }
+    }
+    vector<vector<VariableWidthPath> *> lines = {&slice.gapFill, &slice.thinWalls, &slice.partialShells};
+    for (vector<VariableWidthPath> *feature : lines)
+    {
+        if (feature->size() > 0 && feature->back().path.size() > 0)
+        {
+            position = feature->back().path.back();
+            return true;
+        }
+    }
+    features = {&slice.supportInterface, &slice.support, &slice.raft};
+    for (Clipper2Lib::PathsD *feature : features)
+    {
+        if (feature->size() > 0 && feature->back().size() > 0)
+        {
+            position = feature->back().back();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SeamPlacement::PositionBeforeWalls(Slice &slice, Clipper2Lib::PointD &position)
+{
+    // skirt, raft and support are printed before the walls of the layer
+    vector<Clipper2Lib::PathsD *> features = {&slice.supportInterface, &slice.support, &slice.raft};
+    for (Clipper2Lib::PathsD *feature : features)
+    {
+        if (feature->size() > 0 && feature->back().size() > 0)
+        {
+            position = feature->back().back();
+            return true;
+        }
+    }
+    // skirt loops are closed, they end where they start
+    if (slice.skirt.size() > 0 && slice.skirt.back().size() > 0 && slice.skirt.back().back().size() > 0)
+    {
+        position = slice.skirt.back().back().front();
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,169 @@
+#ifndef SCENE_HPP
+#define SCENE_HPP
+
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "../Model/Model.hpp"
+#include "../Camera/Camera.hpp"
+#include "../DrawSTL/DrawSTL.hpp"
+#include "../Mesh/MeshBounds.hpp"
+#include "../Mesh/MeshParts.hpp"
+#include "../Slicing/Plate/Plate.hpp"
+#include "../Slicing/Plate/Arrange.hpp"
+#include "../Slicing/Orient/Orient.hpp"
+
+// a loaded model and the places on the plate it is printed
+struct SceneObject
+{
+    Model model;
+    glm::mat4 transform; //from the vertices as they were loaded to the mesh in its place above the bed, the vertices are never rewritten
+    vector<Placement> placements;
+    vector<Modifier> modifiers; //volumes in the space of the mesh on the bed where other settings apply
+};
+
+// everything on the build plate, every object is loaded once and drawn and sliced for each of its instances
+class Scene
+{
+private:
+    vector<SceneObject> objects;
+
+public:
+    void AddObject(Model model);
+    void AddInstance(int object);
+    void RemoveInstance(int object, int instance);
+    void AddModifier(int object, vector<Vertex> vertices, SlicerSettings &settings);
+    void RemoveModifier(int object, int modifier);
+    int ArrangePlate(SlicerSettings &settings);
+    void OrientObject(int object, SlicerSettings &settings);
+    void Draw(Shader objectShader, glm::mat4 view, glm::mat4 projection, Camera camera);
+    vector<PlateObject> GetPlateObjects();
+
+    vector<SceneObject> &GetObjects()
+    {
+        return objects;
+    }
+};
+
+void Scene::AddObject(Model model)
+{
+    // every separate body in the file becomes its own object, so it can be sliced, placed and given settings on its own
+    vector<vector<Vertex>> parts = MeshParts::Split(model.meshes[0].vertices);
+    if (parts.size() <= 1)
+    {
+        objects.push_back({model, MeshBounds::PlaceOnBed(model.meshes[0].vertices), {{0, 0, 0}}, {}});
+        return;
+    }
+
+    // the whole file rests on the bed, the bodies keep their place next to and above each other
+    glm::mat4 transform = MeshBounds::PlaceOnBed(model.meshes[0].vertices);
+    for (vector<Vertex> &part : parts)
+    {
+        Bounds bounds = MeshBounds::Calculate(part, transform);
+        Placement placement = {(bounds.lowest.x + bounds.highest.x) / 2, (bounds.lowest.y + bounds.highest.y) / 2, 0};
+        glm::mat4 partTransform = glm::translate(glm::mat4(1.0f), glm::vec3(-placement.x, -placement.y, 0.0f)) * transform;
+        vector<unsigned int> indices(part.size());
+        for (int i = 0; i < indices.size(); i++)
+        {
+            indices[i] = i;
+        }
+        Model partModel = model;
+        partModel.meshes = {Mesh(part, indices, vector<Texture>())};
+        objects.push_back({partModel, partTransform, {placement}, {}});
+    }
+}
+
+void Scene::AddInstance(int object)
+{
+    // the new instance goes to the right of the last one with a gap of 5 mm
+    SceneObject &sceneObject = objects[object];
+    Placement placement = {0, 0, 0};
+    if (sceneObject.placements.size() > 0)
+    {
+        Bounds bounds = MeshBounds::Calculate(sceneObject.model.meshes[0].vertices, sceneObject.transform);
+        placement = sceneObject.placements.back();
+        placement.x += bounds.highest.x - bounds.lowest.x + 5;
+    }
+    sceneObject.placements.push_back(placement);
+}
+
+void Scene::RemoveInstance(int object, int instance)
+{
+    // an object without instances is removed from the scene
+    objects[object].placements.erase(objects[object].placements.begin() + instance);
+    if (objects[object].placements.size() == 0)
+    {
+        objects.erase(objects.begin() + object);
+    }
+}
+
+void Scene::AddModifier(int object, vector<Vertex> vertices, SlicerSettings &settings)
+{
+    // a new modifier stands on the bed in the middle of the object and starts with the current settings
+    Modifier modifier;
+    modifier.transform = MeshBounds::PlaceOnBed(vertices);
+    modifier.vertices = vertices;
+    modifier.shells = settings.GetShells();
+    modifier.infill = settings.GetInfill();
+    modifier.surfaces = settings.GetRoofs();
+    objects[object].modifiers.push_back(modifier);
+}
+
+void Scene::RemoveModifier(int object, int modifier)
+{
+    objects[object].modifiers.erase(objects[object].modifiers.begin() + modifier);
+}
+
+int Scene::ArrangePlate(SlicerSettings &settings)
+{
+    // returns the amount of instances that do not fit on the plate
+    vector<PlateObject> plateObjects = GetPlateObjects();
+    int unplaced = Arrange::ArrangePlate(plateObjects, settings);
+    for (int o = 0; o < objects.size(); o++)
+    {
+        objects[o].placements = plateObjects[o].placements;
+    }
+    return unplaced;
+}
+
+void Scene::OrientObject(int object, SlicerSettings &settings)
+{
+    // only the transform changes, the mesh on the gpu stays as it is
+    SceneObject &sceneObject = objects[object];
+    vector<Vertex> &vertices = sceneObject.model.meshes[0].vertices;
+    glm::mat3 rotation = Orient::FindOrientation(vertices, settings, sceneObject.transform);
+    glm::mat4 transform = MeshBounds::PlaceOnBed(vertices, glm::mat4(rotation) * sceneObject.transform);
+
+    // the modifiers are placed on the mesh as it rests on the bed, they turn and move along with it
+    glm::mat4 change = transform * glm::inverse(sceneObject.transform);
+    for (Modifier &modifier : sceneObject.modifiers)
+    {
+        modifier.transform = change * modifier.transform;
+    }
+    sceneObject.transform = transform;
+}
+
+void Scene::Draw(Shader objectShader, glm::mat4 view, glm::mat4 projection, Camera camera)
+{
+    for (SceneObject &object : objects)
+    {
+        for (Placement &placement : object.placements)
+        {
+            glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(placement.x, placement.y, 0.0f));
+            transform = glm::rotate(transform, glm::radians((float)placement.rotation), glm::vec3(0.0f, 0.0f, 1.0f));
+            DrawSTL::Draw(objectShader, object.model, view, projection, camera, transform * object.transform);
+        }
+    }
+}
+
+vector<PlateObject> Scene::GetPlateObjects()
+{
+    vector<PlateObject> plateObjects;
+    for (SceneObject &object : objects)
+    {
+        plateObjects.push_back({object.model.meshes[0].vertices, object.placements, object.transform, object.modifiers});
+    }
+    return plateObjects;
+}
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef SLICERSETTINGS_H
 #define SLICERSETTINGS_H
 
+#include <algorithm>
+
 struct BuildVolume
 {
     float x;
@@ -8,6 +10,23 @@ struct BuildVolume
     float z;
 };
 
+enum class InfillType {
+    Diagonal,
+    Honeycomb,
+    Triangles
+};
+
+enum class SeamMode {
+    Aligned,
+    Nearest,
+    Rear
+};
+
+enum class SupportType {
+    Normal,
+    Tree
+};
+
 struct Skirt {
     bool enabled;
     int lines;
@@ -15,6 +34,19 @@ struct Skirt {
     double distance;
 };
 
+struct Brim {
+    bool enabled;
+    int lines;
+};
+
+struct Raft {
+    bool enabled;
+    int baseLayers;
+    int interfaceLayers;
+    int surfaceLayers;
+    double margin; //mm around the first layer
+};
+
 class SlicerSettings
 {
 private:
@@ -24,9 +56,37 @@ private:
     float nozzleDiameter; //mm
     int shells;
     float infill; //percentage
+    InfillType infillType;
     int roofs;
     int floors;
     Skirt skirt;
+    Brim brim;
+    Raft raft;
+    bool connectInfill;
+    bool monotonicSurface; //print neighbouring surface lines in one direction across the surface
+    int combineInfill; //print sparse infill every n layers
+    int gradualInfillSteps; //amount of times the infill density doubles below a roof, 0 disables gradual infill
+    int gradualInfillStepLayers; //layers per density step
+    bool variableWidthWalls; //print features thinner than two walls as single lines of variable width
+    bool gapFill; //fill the gaps between walls that are too narrow for another wall
+    float gapFillSpeed; //mm/s
+    float gapFillFlow; //percentage of the normal extrusion
+    SeamMode seamMode; //where closed walls start
+    bool bridges; //print floors without support below as straight lines across the gap
+    float bridgeSpeed; //mm/s
+    float bridgeFlow; //percentage of the normal extrusion
+    bool ironing; //go over the top surfaces again with very little flow to flatten them
+    float ironingSpeed; //mm/s
+    float ironingFlow; //percentage of the normal extrusion
+    float maxDeviation; //mm, how far decimated walls may move away from the sliced contour
+    float minSegmentLength; //mm, shorter wall segments are merged when that stays within the maximum deviation
+    bool supports; //print support below overhangs
+    SupportType supportType; //straight down below the overhangs or branches around the model
+    float supportAngle; //degrees from vertical, steeper overhangs get support
+    float supportDensity; //percentage
+    int supportInterfaceLayers; //dense layers at the top of the support
+    float arrangeSpacing; //mm between the parts when the plate is arranged
+    int slabLayers; //layers per slab when a file is sliced out of core, only the triangles of one slab are in memory
 
 public:
     double GetSlicingPlaneHeight() { return slicingPlaneHeight; }
@@ -44,6 +104,9 @@ public:
     void SetInfill(float inf) {infill = inf;}
     float GetInfill(){return infill;}
 
+    void SetInfillType(InfillType type) { infillType = type; }
+    InfillType GetInfillType() { return infillType; }
+
     void SetRoofs(int roof) { roofs = roof; }
     int GetRoofs() { return roofs; }
 
@@ -56,11 +119,97 @@ public:
     void SetSkirt(Skirt skirt) { this->skirt = skirt; }
     Skirt GetSkirt() { return skirt; }
 
+    void SetBrim(Brim brim) { this->brim = brim; }
+    Brim GetBrim() { return brim; }
+
+    void SetRaft(Raft raft) { this->raft = raft; }
+    Raft GetRaft() { return raft; }
+
+    void SetConnectInfill(bool connect) { connectInfill = connect; }
+    bool GetConnectInfill() { return connectInfill; }
+
+    void SetMonotonicSurface(bool monotonic) { monotonicSurface = monotonic; }
+    bool GetMonotonicSurface() { return monotonicSurface; }
+
+    void SetCombineInfill(int layers) { combineInfill = layers; }
+    int GetCombineInfill() { return combineInfill; }
+    // combined infill can not be thicker than the nozzle can extrude in one pass
+    int GetEffectiveCombineInfill() {
+        int maxLayers = (int)(nozzleDiameter * 0.8f / layerHeight + 0.0001f);
+        return std::max(1, std::min(combineInfill, maxLayers));
+    }
+
+    void SetGradualInfillSteps(int steps) { gradualInfillSteps = steps; }
+    int GetGradualInfillSteps() { return gradualInfillSteps; }
+
+    void SetGradualInfillStepLayers(int layers) { gradualInfillStepLayers = layers; }
+    int GetGradualInfillStepLayers() { return gradualInfillStepLayers; }
+
+    void SetVariableWidthWalls(bool variableWidth) { variableWidthWalls = variableWidth; }
+    bool GetVariableWidthWalls() { return variableWidthWalls; }
+
+    void SetGapFill(bool fill) { gapFill = fill; }
+    bool GetGapFill() { return gapFill; }
+
+    void SetGapFillSpeed(float speed) { gapFillSpeed = speed; }
+    float GetGapFillSpeed() { return gapFillSpeed; }
+
+    void SetGapFillFlow(float flow) { gapFillFlow = flow; }
+    float GetGapFillFlow() { return gapFillFlow; }
+
+    void SetSeamMode(SeamMode mode) { seamMode = mode; }
+    SeamMode GetSeamMode() { return seamMode; }
+
+    void SetBridges(bool enabled) { bridges = enabled; }
+    bool GetBridges() { return bridges; }
+
+    void SetBridgeSpeed(float speed) { bridgeSpeed = speed; }
+    float GetBridgeSpeed() { return bridgeSpeed; }
+
+    void SetBridgeFlow(float flow) { bridgeFlow = flow; }
+    float GetBridgeFlow() { return bridgeFlow; }
+
+    void SetIroning(bool enabled) { ironing = enabled; }
+    bool GetIroning() { return ironing; }
+
+    void SetIroningSpeed(float speed) { ironingSpeed = speed; }
+    float GetIroningSpeed() { return ironingSpeed; }
+
+    void SetIroningFlow(float flow) { ironingFlow = flow; }
+    float GetIroningFlow() { return ironingFlow; }
+
+    void SetMaxDeviation(float deviation) { maxDeviation = deviation; }
+    float GetMaxDeviation() { return maxDeviation; }
+
+    void SetMinSegmentLength(float length) { minSegmentLength = length; }
+    float GetMinSegmentLength() { return minSegmentLength; }
+
+    void SetSupports(bool enabled) { supports = enabled; }
+    bool GetSupports() { return supports; }
+
+    void SetSupportType(SupportType type) { supportType = type; }
+    SupportType GetSupportType() { return supportType; }
+
+    void SetSupportAngle(float angle) { supportAngle = angle; }
+    float GetSupportAngle() { return supportAngle; }
+
+    void SetSupportDensity(float density) { supportDensity = density; }
+    float GetSupportDensity() { return supportDensity; }
+
+    void SetSupportInterfaceLayers(int layers) { supportInterfaceLayers = layers; }
+    int GetSupportInterfaceLayers() { return supportInterfaceLayers; }
+
+    void SetArrangeSpacing(float spacing) { arrangeSpacing = spacing; }
+    float GetArrangeSpacing() { return arrangeSpacing; }
+
+    void SetSlabLayers(int layers) { slabLayers = layers; }
+    int GetSlabLayers() { return slabLayers; }
+
     SlicerSettings();
     ~SlicerSettings();
 };
 
-SlicerSettings::SlicerSettings() : slicingPlaneHeight(0.000000001) , layerHeight(0.2f), nozzleDiameter(0.4f), shells(2), buildVolume({220,220,250}), infill(20), roofs(3), floors(3), skirt({false, 3, 2, 5})
+SlicerSettings::SlicerSettings() : slicingPlaneHeight(0.000000001) , layerHeight(0.2f), nozzleDiameter(0.4f), shells(2), buildVolume({220,220,250}), infill(20), infillType(InfillType::Diagonal), roofs(3), floors(3), skirt({false, 3, 2, 5}), brim({false, 8}), raft({false, 1, 1, 2, 3}), connectInfill(true), monotonicSurface(false), combineInfill(1), gradualInfillSteps(0), gradualInfillStepLayers(5), variableWidthWalls(false), gapFill(false), gapFillSpeed(15), gapFillFlow(100), seamMode(SeamMode::Aligned), bridges(false), bridgeSpeed(15), bridgeFlow(90), ironing(false), ironingSpeed(15), ironingFlow(10), maxDeviation(0.025f), minSegmentLength(0.2f), supports(false), supportType(SupportType::Normal), supportAngle(50), supportDensity(15), supportInterfaceLayers(2), arrangeSpacing(5), slabLayers(64)
 {
 }
 
@@ -0,0 +1,157 @@
+#ifndef ADHESION_HPP
+#define ADHESION_HPP
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "clipper2/clipper.h"
+#include "../../SlicerSettings/SlicerSettings.hpp"
+#include "../Infill/CreateInfill.hpp"
+#include "../Infill/ConnectInfill.hpp"
+#include "../Walls/ShellLadder.hpp"
+
+// everything printed on the bed to get the model to stick: skirt, brim and raft
+// the outline of the first layer is computed once, every loop is an offset of that outline
+class Adhesion
+{
+private:
+    static Clipper2Lib::PathD ConvexHull(Clipper2Lib::PathsD &paths);
+    static Clipper2Lib::PathsD OuterContours(Clipper2Lib::PathsD &paths);
+
+public:
+    static vector<Clipper2Lib::PathsD> CreateSkirt(Clipper2Lib::PathsD &firstLayer, SlicerSettings &settings);
+    static vector<Clipper2Lib::PathsD> CreateBrim(Clipper2Lib::PathsD &firstLayer, SlicerSettings &settings);
+    static Clipper2Lib::PathsD CreateRaftArea(Clipper2Lib::PathsD &firstLayer, SlicerSettings &settings);
+    static vector<Clipper2Lib::PathsD> CreateRaftLayers(CreateInfill &infillCreator, Clipper2Lib::PathsD &raftArea, SlicerSettings &settings);
+};
+
+vector<Clipper2Lib::PathsD> Adhesion::CreateSkirt(Clipper2Lib::PathsD &firstLayer, SlicerSettings &settings)
+{
+    // the skirt only has to prime the nozzle, it goes around the convex hull so it is one loop per line whatever the model looks like
+    Clipper2Lib::PathsD hull = {ConvexHull(firstLayer)};
+    if (hull[0].size() < 3)
+    {
+        return vector<Clipper2Lib::PathsD>();
+    }
+
+    vector<double> distances;
+    for (int j = 0; j < settings.GetSkirt().lines; j++)
+    {
+        distances.push_back(settings.GetNozzleDiameter() * j + settings.GetSkirt().distance);
+    }
+    return ShellLadder::Offset(hull, distances, Clipper2Lib::JoinType::Round);
+}
+
+vector<Clipper2Lib::PathsD> Adhesion::CreateBrim(Clipper2Lib::PathsD &firstLayer, SlicerSettings &settings)
+{
+    // the brim is attached to the outside of every island, the first loop touches the outer wall
+    Clipper2Lib::PathsD outline = OuterContours(firstLayer);
+    vector<double> distances;
+    for (int j = 1; j <= settings.GetBrim().lines; j++)
+    {
+        distances.push_back(settings.GetNozzleDiameter() * j);
+    }
+    return ShellLadder::Offset(outline, distances, Clipper2Lib::JoinType::Round);
+}
+
+Clipper2Lib::PathsD Adhesion::CreateRaftArea(Clipper2Lib::PathsD &firstLayer, SlicerSettings &settings)
+{
+    // holes are filled, the raft is one flat plate below the model
+    Clipper2Lib::PathsD outline = OuterContours(firstLayer);
+    return ShellLadder::Offset(outline, settings.GetRaft().margin, Clipper2Lib::JoinType::Round);
+}
+
+vector<Clipper2Lib::PathsD> Adhesion::CreateRaftLayers(CreateInfill &infillCreator, Clipper2Lib::PathsD &raftArea, SlicerSettings &settings)
+{
+    // coarse base lines that grip the bed, an interface across them and dense surface layers the model is printed on
+    Raft raft = settings.GetRaft();
+    double nozzleDiameter = settings.GetNozzleDiameter();
+    Clipper2Lib::PathsD clipArea = ShellLadder::Offset(raftArea, -nozzleDiameter / 2);
+    int layerCount = raft.baseLayers + raft.interfaceLayers + raft.surfaceLayers;
+
+    vector<Clipper2Lib::PathsD> layers(layerCount);
+    #pragma omp parallel for
+    for (int i = 0; i < layerCount; i++)
+    {
+        double spacing = nozzleDiameter;
+        double angle = i % 2 == 0 ? M_PI / 4 : M_PI * 3 / 4;
+        if (i < raft.baseLayers)
+        {
+            spacing = nozzleDiameter * 2.5;
+            angle = 0;
+        }
+        else if (i < raft.baseLayers + raft.interfaceLayers)
+        {
+            spacing = nozzleDiameter * 1.5;
+            angle = M_PI / 2;
+        }
+
+        Clipper2Lib::PathsD lines = CreateInfill::CreateScanlines(Clipper2Lib::GetBounds(clipArea), spacing, angle);
+        lines = infillCreator.ClipInfill(lines, clipArea);
+        layers[i] = ConnectInfill::Connect(lines, clipArea, spacing * 3);
+
+        // the base is held together by an outline
+        if (i < raft.baseLayers)
+        {
+            for (Clipper2Lib::PathD outline : clipArea)
+            {
+                outline.push_back(outline.front());
+                layers[i].push_back(outline);
+            }
+        }
+    }
+    return layers;
+}
+
+Clipper2Lib::PathsD Adhesion::OuterContours(Clipper2Lib::PathsD &paths)
+{
+    Clipper2Lib::PathsD outer;
+    for (Clipper2Lib::PathD &path : paths)
+    {
+        if (Clipper2Lib::IsPositive(path))
+        {
+            outer.push_back(path);
+        }
+    }
+    return Clipper2Lib::Union(outer, Clipper2Lib::FillRule::NonZero);
+}
+
+Clipper2Lib::PathD Adhesion::ConvexHull(Clipper2Lib::PathsD &paths)
+{
+    // monotone chain, counter clockwise like the outer contours
+    vector<Clipper2Lib::PointD> points;
+    for (Clipper2Lib::PathD &path : paths)
+    {
+        points.insert(points.end(), path.begin(), path.end());
+    }
+    sort(points.begin(), points.end(), [](const Clipper2Lib::PointD &a, const Clipper2Lib::PointD &b) {
+        return a.x < b.x || (a.x == b.x && a.y < b.y);
+    });
+    if (points.size() < 3)
+    {
+        return Clipper2Lib::PathD(points.begin(), points.end());
+    }
+
+    Clipper2Lib::PathD hull(points.size() * 2);
+    int k = 0;
+    for (int i = 0; i < points.size(); i++)
+    {
+        while (k >= 2 && Clipper2Lib::CrossProduct(hull[k - 2], hull[k - 1], points[i]) <= 0)
+        {
+            k--;
+        }
+        hull[k++] = points[i];
+    }
+    for (int i = points.size() - 2, lower = k + 1; i >= 0; i--)
+    {
+        while (k >= lower && Clipper2Lib::CrossProduct(hull[k - 2], hull[k - 1], points[i]) <= 0)
+        {
+            k--;
+        }
+        hull[k++] = points[i];
+    }
+    hull.resize(k - 1);
+    return hull;
+}
+
+#endif
@@ -95,9 +95,13 @@ private:
     void WriteSkirt(ofstream& file, vector<Clipper2Lib::PathsD>& skirts, double height);
     void WriteShells(ofstream &file, vector<Clipper2Lib::PathsD> &shells, double height);
     void WriteWalls(ofstream &file, Clipper2Lib::PathsD &walls, double height);
-    void WriteInfill(ofstream &file, Clipper2Lib::PathsD &infill, double height);
+    void WriteVariableWidthWalls(ofstream &file, vector<VariableWidthPath> &walls, double height);
+    void WriteGapFill(ofstream &file, vector<VariableWidthPath> &gapFill, double height);
+    void WriteInfill(ofstream &file, Clipper2Lib::PathsD &infill, double height, int layers = 1);
     void WriteSurfaceWalls(ofstream &file, Clipper2Lib::PathsD &walls, double height);
     void WriteSurfaceInfill(ofstream &file, Clipper2Lib::PathsD &infill, double height);
+    void WriteBridges(ofstream &file, Clipper2Lib::PathsD &bridges, double height);
+    void WriteIroning(ofstream &file, Clipper2Lib::PathsD &ironing, double height);
 
 public:
     GCodeWriter(SlicerSettings &settings)
@@ -234,16 +238,33 @@ void GCodeWriter::WriteGCode(string dirname, vector<Slice> &slices) {
         
         // skirt or brim first
         WriteSkirt(file, slice.skirt, layerHeight * (i + 1));
+        // raft layers only have the raft
+        WriteInfill(file, slice.raft, layerHeight*(i+1));
+        // support before the model, the overhangs above it are printed on the support of the layer below
+        WriteInfill(file, slice.support, layerHeight*(i+1));
+        WriteInfill(file, slice.supportInterface, layerHeight*(i+1));
         // shells first
         WriteShells(file, slice.shells, layerHeight*(i+1));
+        //shells that stop at the border of a modifier
+        WriteVariableWidthWalls(file, slice.partialShells, layerHeight*(i+1));
         //then walls
         WriteWalls(file, slice.outerWall, layerHeight*(i+1));
+        //then the parts too thin for walls
+        WriteVariableWidthWalls(file, slice.thinWalls, layerHeight*(i+1));
+        //then the gaps between the walls, at their own speed and flow
+        WriteGapFill(file, slice.gapFill, layerHeight*(i+1));
         //then surface walls
         WriteSurfaceWalls(file, slice.surfaceWall, layerHeight*(i+1));
         //then surface infill
         WriteSurfaceInfill(file, slice.surface, layerHeight*(i+1));
+        //then bridges, at their own speed and flow
+        WriteBridges(file, slice.bridges, layerHeight*(i+1));
         //then infill
         WriteInfill(file, slice.infill, layerHeight*(i+1));
+        //then infill combined over multiple layers
+        WriteInfill(file, slice.combinedInfill, layerHeight*(i+1), slice.combinedInfillLayers);
+        //ironing goes over everything else that is printed on this layer
+        WriteIroning(file, slice.ironing, layerHeight*(i+1));
 
         // turn on fan in the first three layers
         if (i == 0){
@@ -269,22 +290,25 @@ void GCodeWriter::WriteSkirt(ofstream& file, vector<Clipper2Lib::PathsD>& skirts
 	string speedString = "F" + to_string(this->speed*60);
 	string printSpeed = "F" + to_string(this->speed*30);
 	for (int i = 0; i < skirts.size(); i++){
-		Clipper2Lib::PathD path = skirts[i][0];
-		// go to start of path
-		file << "G0 " << speedString << " X" << path[0].x + bedCenterX << " Y" << path[0].y + bedCenterY << " Z" << height << "\n";
-		if (retracted){
-			extrudedLength += retractionLength;
-			retracted = false;
-		}
-		file << "G1 " << printSpeed << " E" << to_string(extrudedLength) << "\n";
-
-		//print the path
-		for (int k = 1; k < path.size(); k++){
-			double distance = glm::distance(glm::vec2(path[k].x, path[k].y), glm::vec2(path[k-1].x, path[k-1].y));
-			double E = distance * width * layerHeight / extrusionVal;
-			extrudedLength += E;
-			string extruded = " E" + to_string(extrudedLength);
-			file << "G1 " << printSpeed << " X" << path[k].x + bedCenterX << " Y" << path[k].y + bedCenterY << extruded << "\n";
+		for (int j = 0; j < skirts[i].size(); j++){
+			Clipper2Lib::PathD path = skirts[i][j];
+			// go to start of path
+			file << "G0 " << speedString << " X" << path[0].x + bedCenterX << " Y" << path[0].y + bedCenterY << " Z" << height << "\n";
+			if (retracted){
+				extrudedLength += retractionLength;
+				retracted = false;
+			}
+			file << "G1 " << printSpeed << " E" << to_string(extrudedLength) << "\n";
+
+			//print the loop and close it
+			path.push_back(path[0]);
+			for (int k = 1; k < path.size(); k++){
+				double distance = glm::distance(glm::vec2(path[k].x, path[k].y), glm::vec2(path[k-1].x, path[k-1].y));
+				double E = distance * width * layerHeight / extrusionVal;
+				extrudedLength += E;
+				string extruded = " E" + to_string(extrudedLength);
+				file << "G1 " << printSpeed << " X" << path[k].x + bedCenterX << " Y" << path[k].y + bedCenterY << extruded << "\n";
+			}
 		}
 	}
 	//retract
@@ -372,7 +396,72 @@ void GCodeWriter::WriteWalls(ofstream &file, Clipper2Lib::PathsD &walls, double
     }
 }
 
-void GCodeWriter::WriteInfill(ofstream &file, Clipper2Lib::PathsD &infill, double height){
+void GCodeWriter::WriteVariableWidthWalls(ofstream &file, vector<VariableWidthPath> &walls, double height){
+    string speedString = "F" + to_string(this->speed*60);
+    string printSpeed = "F" + to_string(this->speed*30);
+    for (int i = 0; i < walls.size(); i++){
+        Clipper2Lib::PathD path = walls[i].path;
+        // go to start of path
+        file << "G0 " << speedString << " X" << path[0].x + bedCenterX << " Y" << path[0].y + bedCenterY << " Z" << height << "\n";
+        if (retracted){
+            extrudedLength += retractionLength;
+            retracted = false;
+        }
+        file << "G1 " << printSpeed << " E" << to_string(extrudedLength) << "\n";
+
+        //print the path, every segment uses the average width of its vertices
+        for (int k = 1; k < path.size(); k++){
+            double distance = glm::distance(glm::vec2(path[k].x, path[k].y), glm::vec2(path[k-1].x, path[k-1].y));
+            double segmentWidth = (walls[i].widths[k] + walls[i].widths[k-1]) / 2;
+            double E = distance * segmentWidth * layerHeight / extrusionVal;
+            extrudedLength += E;
+            string extruded = " E" + to_string(extrudedLength);
+            file << "G1 " << printSpeed << " X" << path[k].x + bedCenterX << " Y" << path[k].y + bedCenterY << extruded << "\n";
+        }
+
+        //retract
+        if (retract && !retracted){
+            extrudedLength -= retractionLength;
+            retracted = true;
+            file << "G1 E" << to_string(extrudedLength) << " F" << to_string(retractionSpeed) << "\n";
+        }
+    }
+}
+
+void GCodeWriter::WriteGapFill(ofstream &file, vector<VariableWidthPath> &gapFill, double height){
+    string speedString = "F" + to_string(this->speed*60);
+    string printSpeed = "F" + to_string(settings->GetGapFillSpeed()*60);
+    double flow = settings->GetGapFillFlow() / 100;
+    for (int i = 0; i < gapFill.size(); i++){
+        Clipper2Lib::PathD path = gapFill[i].path;
+        // go to start of path
+        file << "G0 " << speedString << " X" << path[0].x + bedCenterX << " Y" << path[0].y + bedCenterY << " Z" << height << "\n";
+        if (retracted){
+            extrudedLength += retractionLength;
+            retracted = false;
+        }
+        file << "G1 " << printSpeed << " E" << to_string(extrudedLength) << "\n";
+
+        //print the path, every segment uses the average width of its vertices
+        for (int k = 1; k < path.size(); k++){
+            double distance = glm::distance(glm::vec2(path[k].x, path[k].y), glm::vec2(path[k-1].x, path[k-1].y));
+            double segmentWidth = (gapFill[i].widths[k] + gapFill[i].widths[k-1]) / 2;
+            double E = distance * segmentWidth * layerHeight * flow / extrusionVal;
+            extrudedLength += E;
+            string extruded = " E" + to_string(extrudedLength);
+            file << "G1 " << printSpeed << " X" << path[k].x + bedCenterX << " Y" << path[k].y + bedCenterY << extruded << "\n";
+        }
+
+        //retract
+        if (retract && !retracted){
+            extrudedLength -= retractionLength;
+            retracted = true;
+            file << "G1 E" << to_string(extrudedLength) << " F" << to_string(retractionSpeed) << "\n";
+        }
+    }
+}
+
+void GCodeWriter::WriteInfill(ofstream &file, Clipper2Lib::PathsD &infill, double height, int layers){
     string speedString = "F" + to_string(this->speed*60);
     string printSpeed = "F" + to_string(this->speed*60);
     for (int i = 0; i < infill.size(); i++){
@@ -388,7 +477,7 @@ void GCodeWriter::WriteInfill(ofstream &file, Clipper2Lib::PathsD &infill, doubl
         //print the path
         for (int k = 1; k < path.size(); k++){
             double distance = glm::distance(glm::vec2(path[k].x, path[k].y), glm::vec2(path[k-1].x, path[k-1].y));
-            double E = distance * width * layerHeight / extrusionVal;
+            double E = distance * width * layerHeight * layers / extrusionVal;
             extrudedLength += E;
             string extruded = " E" + to_string(extrudedLength);
             file << "G1 " << printSpeed << " X" << path[k].x + bedCenterX << " Y" << path[k].y + bedCenterY << extruded << "\n";
@@ -481,4 +570,68 @@ void GCodeWriter::WriteSurfaceInfill(ofstream &file, Clipper2Lib::PathsD &infill
     }
 }
 
+void GCodeWriter::WriteBridges(ofstream &file, Clipper2Lib::PathsD &bridges, double height){
+    string speedString = "F" + to_string(this->speed*60);
+    string printSpeed = "F" + to_string(settings->GetBridgeSpeed()*60);
+    double flow = settings->GetBridgeFlow() / 100;
+    for (int i = 0; i < bridges.size(); i++){
+        Clipper2Lib::PathD path = bridges[i];
+        // go to start of path
+        file << "G0 " << speedString << " X" << path[0].x + bedCenterX << " Y" << path[0].y + bedCenterY << " Z" << height << "\n";
+        if (retracted){
+            extrudedLength += retractionLength;
+            retracted = false;
+        }
+        file << "G1 " << printSpeed << " E" << to_string(extrudedLength) << "\n";
+
+        //print the path
+        for (int k = 1; k < path.size(); k++){
+            double distance = glm::distance(glm::vec2(path[k].x, path[k].y), glm::vec2(path[k-1].x, path[k-1].y));
+            double E = distance * width * layerHeight * flow / extrusionVal;
+            extrudedLength += E;
+            string extruded = " E" + to_string(extrudedLength);
+            file << "G1 " << printSpeed << " X" << path[k].x + bedCenterX << " Y" << path[k].y + bedCenterY << extruded << "\n";
+        }
+
+        //retract
+        if (retract && !retracted){
+            extrudedLength -= retractionLength;
+            retracted = true;
+            file << "G1 E" << to_string(extrudedLength) << " F" << to_string(retractionSpeed) << "\n";
+        }
+    }
+}
+
+void GCodeWriter::WriteIroning(ofstream &file, Clipper2Lib::PathsD &ironing, double height){
+    string speedString = "F" + to_string(this->speed*60);
+    string printSpeed = "F" + to_string(settings->GetIroningSpeed()*60);
+    double flow = settings->GetIroningFlow() / 100;
+    for (int i = 0; i < ironing.size(); i++){
+        Clipper2Lib::PathD path = ironing[i];
+        // go to start of path
+        file << "G0 " << speedString << " X" << path[0].x + bedCenterX << " Y" << path[0].y + bedCenterY << " Z" << height << "\n";
+        if (retracted){
+            extrudedLength += retractionLength;
+            retracted = false;
+        }
+        file << "G1 " << printSpeed << " E" << to_string(extrudedLength) << "\n";
+
+        //print the path
+        for (int k = 1; k < path.size(); k++){
+            double distance = glm::distance(glm::vec2(path[k].x, path[k].y), glm::vec2(path[k-1].x, path[k-1].y));
+            double E = distance * width * layerHeight * flow / extrusionVal;
+            extrudedLength += E;
+            string extruded = " E" + to_string(extrudedLength);
+            file << "G1 " << printSpeed << " X" << path[k].x + bedCenterX << " Y" << path[k].y + bedCenterY << extruded << "\n";
+        }
+
+        //retract
+        if (retract && !retracted){
+            extrudedLength -= retractionLength;
+            retracted = true;
+            file << "G1 E" << to_string(extrudedLength) << " F" << to_string(retractionSpeed) << "\n";
+        }
+    }
+}
+
 #endif
\ No newline at end of file
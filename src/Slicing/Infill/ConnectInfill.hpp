@@ -0,0 +1,313 @@
+#ifndef CONNECTINFILL_HPP
+#define CONNECTINFILL_HPP
+
+#include <vector>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include "clipper2/clipper.h"
+
+// joins clipped infill/surface lines into zig-zag polylines by following the boundary of the clip area
+class ConnectInfill
+{
+private:
+    struct EndPoint
+    {
+        int line;       // index of the line this endpoint belongs to
+        int end;        // 0 = first point of the line, 1 = last point
+        int contour;    // boundary contour the endpoint lies on
+        int edge;       // edge of the contour (from vertex edge to edge+1)
+        double arcPos;  // distance along the contour from its first vertex
+    };
+
+    struct Link
+    {
+        int from;       // index into the endpoint list
+        int to;         // next endpoint along the contour (increasing arcPos)
+        double length;  // length of the boundary between both endpoints
+    };
+
+    static int FindRoot(vector<int> &parents, int i);
+    static bool ProjectOnBoundary(Clipper2Lib::PointD &point, Clipper2Lib::PathsD &boundary, vector<vector<double>> &arcLengths,
+                                  unordered_map<int64_t, vector<pair<int, int>>> &grid, double cellSize, double tolerance, EndPoint &result);
+    static void AppendBoundary(Clipper2Lib::PathD &chain, Clipper2Lib::PathD &contour, EndPoint &from, EndPoint &to, bool forward);
+
+    static int64_t CellKey(int x, int y) { return (int64_t)(((uint64_t)(uint32_t)x << 32) ^ (uint32_t)y); }
+
+public:
+    static Clipper2Lib::PathsD Connect(Clipper2Lib::PathsD &lines, Clipper2Lib::PathsD &boundary, double maxConnection);
+};
+
+Clipper2Lib::PathsD ConnectInfill::Connect(Clipper2Lib::PathsD &lines, Clipper2Lib::PathsD &boundary, double maxConnection)
+{
+    if (lines.size() <= 1 || boundary.size() == 0)
+    {
+        return lines;
+    }
+
+    // clipped endpoints lie on the boundary up to the clipper precision (0.01mm)
+    double tolerance = 0.02;
+    double cellSize = 2.0;
+
+    // cumulative arc length of every boundary vertex, and a grid of the boundary edges for fast lookups
+    vector<vector<double>> arcLengths(boundary.size());
+    unordered_map<int64_t, vector<pair<int, int>>> grid;
+    for (int c = 0; c < boundary.size(); c++)
+    {
+        Clipper2Lib::PathD &contour = boundary[c];
+        arcLengths[c].resize(contour.size() + 1, 0);
+        for (int e = 0; e < contour.size(); e++)
+        {
+            Clipper2Lib::PointD a = contour[e];
+            Clipper2Lib::PointD b = contour[(e + 1) % contour.size()];
+            arcLengths[c][e + 1] = arcLengths[c][e] + sqrt(pow(b.x - a.x, 2) + pow(b.y - a.y, 2));
+
+            int minX = (int)floor((min(a.x, b.x) - tolerance) / cellSize);
+            int maxX = (int)floor((max(a.x, b.x) + tolerance) / cellSize);
+            int minY = (int)floor((min(a.y, b.y) - tolerance) / cellSize);
+            int maxY = (int)floor((max(a.y, b.y) + tolerance) / cellSize);
+            for (int x = minX; x <= maxX; x++)
+            {
+                for (int y = minY; y <= maxY; y++)
+                {
+                    grid[CellKey(x, y)].push_back({c, e});
+                }
+            }
+        }
+    }
+
+    // find where every line endpoint touches the boundary
+    vector<EndPoint> endPoints;
+    for (int i = 0; i < lines.size(); i++)
+    {
+        if (lines[i].size() < 2)
+        {
+            continue;
+        }
+        for (int end = 0; end < 2; end++)
+        {
+            Clipper2Lib::PointD point = end == 0 ? lines[i].front() : lines[i].back();
+            EndPoint endPoint;
+            if (ProjectOnBoundary(point, boundary, arcLengths, grid, cellSize, tolerance, endPoint))
+            {
+                endPoint.line = i;
+                endPoint.end = end;
+                endPoints.push_back(endPoint);
+            }
+        }
+    }
+
+    // sort the endpoints along their contour, neighbours along the contour are connection candidates
+    sort(endPoints.begin(), endPoints.end(), [](const EndPoint &a, const EndPoint &b) {
+        if (a.contour != b.contour)
+            return a.contour < b.contour;
+        return a.arcPos < b.arcPos;
+    });
+
+    vector<Link> links;
+    int first = 0;
+    while (first < endPoints.size())
+    {
+        int last = first;
+        while (last + 1 < endPoints.size() && endPoints[last + 1].contour == endPoints[first].contour)
+        {
+            last++;
+        }
+
+        double perimeter = arcLengths[endPoints[first].contour].back();
+        int count = last - first + 1;
+        for (int k = 0; k < count && count > 1; k++)
+        {
+            int from = first + k;
+            int to = first + (k + 1) % count;
+            double length = endPoints[to].arcPos - endPoints[from].arcPos;
+            if (length < 0)
+            {
+                length += perimeter;
+            }
+            if (length <= maxConnection && endPoints[from].line != endPoints[to].line)
+            {
+                links.push_back({from, to, length});
+            }
+        }
+        first = last + 1;
+    }
+
+    // greedily accept the shortest connections, every endpoint is used once and lines never form a loop
+    // (near) equal connections keep their order along the contour, which makes parallel lines alternate into a zig-zag
+    stable_sort(links.begin(), links.end(), [](const Link &a, const Link &b) {
+        return llround(a.length / 0.05) < llround(b.length / 0.05);
+    });
+
+    vector<int> parents(lines.size());
+    iota(parents.begin(), parents.end(), 0);
+    vector<bool> used(endPoints.size(), false);
+
+    // for every line end: the endpoint index it is connected to, and whether the link runs along the contour direction
+    vector<array<int, 2>> connectedTo(lines.size(), {-1, -1});
+    vector<array<int, 2>> ownEndPoint(lines.size(), {-1, -1});
+    vector<array<bool, 2>> forward(lines.size(), {true, true});
+    for (int i = 0; i < endPoints.size(); i++)
+    {
+        ownEndPoint[endPoints[i].line][endPoints[i].end] = i;
+    }
+
+    for (Link &link : links)
+    {
+        if (used[link.from] || used[link.to])
+        {
+            continue;
+        }
+        EndPoint &a = endPoints[link.from];
+        EndPoint &b = endPoints[link.to];
+        int rootA = FindRoot(parents, a.line);
+        int rootB = FindRoot(parents, b.line);
+        if (rootA == rootB)
+        {
+            continue;
+        }
+        parents[rootA] = rootB;
+        used[link.from] = true;
+        used[link.to] = true;
+        connectedTo[a.line][a.end] = link.to;
+        forward[a.line][a.end] = true;
+        connectedTo[b.line][b.end] = link.from;
+        forward[b.line][b.end] = false;
+    }
+
+    // walk the chains starting from a line that has at least one free end
+    Clipper2Lib::PathsD connected;
+    vector<bool> visited(lines.size(), false);
+    for (int i = 0; i < lines.size(); i++)
+    {
+        if (visited[i] || lines[i].size() < 2)
+        {
+            continue;
+        }
+        if (connectedTo[i][0] != -1 && connectedTo[i][1] != -1)
+        {
+            continue;
+        }
+
+        Clipper2Lib::PathD chain;
+        int line = i;
+        int entry = connectedTo[i][0] == -1 ? 0 : 1;
+        while (line != -1)
+        {
+            visited[line] = true;
+            if (entry == 0)
+            {
+                chain.insert(chain.end(), lines[line].begin(), lines[line].end());
+            }
+            else
+            {
+                chain.insert(chain.end(), lines[line].rbegin(), lines[line].rend());
+            }
+
+            int exit = 1 - entry;
+            int next = connectedTo[line][exit];
+            if (next == -1)
+            {
+                break;
+            }
+
+            EndPoint &from = endPoints[ownEndPoint[line][exit]];
+            EndPoint &to = endPoints[next];
+            AppendBoundary(chain, boundary[from.contour], from, to, forward[line][exit]);
+
+            line = to.line;
+            entry = to.end;
+        }
+        connected.push_back(chain);
+    }
+
+    return connected;
+}
+
+int ConnectInfill::FindRoot(vector<int> &parents, int i)
+{
+    while (parents[i] != i)
+    {
+        parents[i] = parents[parents[i]];
+        i = parents[i];
+    }
+    return i;
+}
+
+bool ConnectInfill::ProjectOnBoundary(Clipper2Lib::PointD &point, Clipper2Lib::PathsD &boundary, vector<vector<double>> &arcLengths,
+                                      unordered_map<int64_t, vector<pair<int, int>>> &grid, double cellSize, double tolerance, EndPoint &result)
+{
+    auto cell = grid.find(CellKey((int)floor(point.x / cellSize), (int)floor(point.y / cellSize)));
+    if (cell == grid.end())
+    {
+        return false;
+    }
+
+    double closest = tolerance;
+    bool found = false;
+    for (pair<int, int> &edge : cell->second)
+    {
+        Clipper2Lib::PathD &contour = boundary[edge.first];
+        Clipper2Lib::PointD a = contour[edge.second];
+        Clipper2Lib::PointD b = contour[(edge.second + 1) % contour.size()];
+
+        double dx = b.x - a.x;
+        double dy = b.y - a.y;
+        double lengthSq = dx * dx + dy * dy;
+        double t = lengthSq > 0 ? ((point.x - a.x) * dx + (point.y - a.y) * dy) / lengthSq : 0;
+        t = max(0.0, min(1.0, t));
+
+        double distance = sqrt(pow(a.x + t * dx - point.x, 2) + pow(a.y + t * dy - point.y, 2));
+        if (distance <= closest)
+        {
+            closest = distance;
+            found = true;
+            result.contour = edge.first;
+            result.edge = edge.second;
+            result.arcPos = arcLengths[edge.first][edge.second] + t * sqrt(lengthSq);
+        }
+    }
+
+    return found;
+}
+
+void ConnectInfill::AppendBoundary(Clipper2Lib::PathD &chain, Clipper2Lib::PathD &contour, EndPoint &from, EndPoint &to, bool forward)
+{
+    // only the contour vertices between both endpoints are added, the endpoints themselves belong to the lines
+    int n = contour.size();
+    if (forward)
+    {
+        if (from.edge == to.edge && to.arcPos >= from.arcPos)
+        {
+            return;
+        }
+        for (int v = (from.edge + 1) % n; ; v = (v + 1) % n)
+        {
+            chain.push_back(contour[v]);
+            if (v == to.edge)
+            {
+                break;
+            }
+        }
+    }
+    else
+    {
+        if (from.edge == to.edge && to.arcPos <= from.arcPos)
+        {
+            return;
+        }
+        for (int v = from.edge; ; v = (v - 1 + n) % n)
+        {
+            chain.push_back(contour[v]);
+            if (v == (to.edge + 1) % n)
+            {
+                break;
+            }
+        }
+    }
+}
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "clipper2/clipper.h"
 #include "../../SlicerSettings/SlicerSettings.hpp"
+#include "InfillPattern.hpp"
 
 class CreateInfill
 {
@@ -10,12 +11,34 @@ private:
     Clipper2Lib::PathsD infill;
     Clipper2Lib::PathsD evenSurface;
     Clipper2Lib::PathsD oddSurface;
+    double infillSpacing = 0; //distance between neighbouring parallel lines
+    double surfaceSpacing = 0;
+
+    // tile based patterns are instantiated per layer instead of stored for the full build plate
+    InfillType infillType = InfillType::Diagonal;
+    float infillDensity = 0;
+    float nozzleDiameter = 0;
+
+    // denser versions of the sparse infill for gradual infill, level k has 2^k times the base density
+    vector<float> gradualDensity;
+    vector<double> gradualSpacing;
+    vector<Clipper2Lib::PathsD> gradualInfill; //only used by the diagonal pattern, tile patterns are cached per density
+
+    static bool IsAxisAlignedRectangle(Clipper2Lib::PathD &path, Clipper2Lib::RectD &bounds);
+    static Clipper2Lib::PathsD CullDiagonal(Clipper2Lib::PathsD &lines, double step, Clipper2Lib::RectD bounds);
 public:
     void CreateRectInfill(float density, SlicerSettings settings);
     void CreateDiagonalInfill(float density, SlicerSettings settings);
     void CreateSurfaceInfill(int evenOdd, SlicerSettings settings);
+    void CreatePatternInfill(InfillType type, float density, SlicerSettings settings);
+    void CreateGradualInfill(int steps, SlicerSettings settings);
+    static Clipper2Lib::PathsD CreateScanlines(Clipper2Lib::RectD bounds, double spacing, double angle);
 
     Clipper2Lib::PathsD GetInfill() { return infill; }
+    Clipper2Lib::PathsD GetInfill(Clipper2Lib::RectD bounds, int level = 0);
+    double GetInfillSpacing(int level = 0) { return level == 0 ? infillSpacing : gradualSpacing[level - 1]; }
+    int GetGradualLevels() { return gradualDensity.size(); }
+    double GetSurfaceSpacing() { return surfaceSpacing; }
     Clipper2Lib::PathsD GetSurface(int i) { 
         if (i%2 == 0) {
             return evenSurface;
@@ -94,12 +117,13 @@ void CreateInfill::CreateDiagonalInfill(float density, SlicerSettings settings){
     //check the largest distance to determine used param
     float maxDist = max((maxY=minY), (maxX-minX));
 
-    //calculate the amount of lines needed
-    int lines = maxDist / spacing;
-
     //calculate manhattan values according to pythagorean theorem
     //a^2 + b^2 = c^2
     float x_component = spacing * spacing / 2;
+    this->infillSpacing = x_component * sqrt(2);
+
+    //calculate the amount of lines needed, the lines are x_component apart along the x axis and have to cover the whole plate
+    int lines = maxDist / x_component + 1;
 
 
     //draw lines
@@ -173,6 +197,7 @@ void CreateInfill::CreateSurfaceInfill(int evenOdd, SlicerSettings settings){
     // a² = c² / 2
     // a = sqrt(c² / 2)
     float x_component = sqrt(spacing * spacing / 2);
+    this->surfaceSpacing = x_component * sqrt(2);
 
     // draw lines
     for (int i = 0; i < lines; i++)
@@ -219,16 +244,212 @@ void CreateInfill::CreateSurfaceInfill(int evenOdd, SlicerSettings settings){
     }
 }
 
+void CreateInfill::CreatePatternInfill(InfillType type, float density, SlicerSettings settings){
+    this->infillType = type;
+    this->infillDensity = density;
+    this->nozzleDiameter = settings.GetNozzleDiameter();
+
+    if (type == InfillType::Diagonal) {
+        CreateDiagonalInfill(density, settings);
+        return;
+    }
+
+    // builds (or reuses) the cached tile of the pattern
+    this->infillSpacing = InfillPattern::GetTile(type, density, nozzleDiameter).spacing;
+}
+
+void CreateInfill::CreateGradualInfill(int steps, SlicerSettings settings){
+    gradualDensity.clear();
+    gradualSpacing.clear();
+    gradualInfill.clear();
+
+    // the diagonal pattern is created for the full build plate, keep the base pattern while creating the denser ones
+    Clipper2Lib::PathsD baseInfill = infill;
+    double baseSpacing = infillSpacing;
+
+    for (int level = 1; level <= steps; level++) {
+        float density = min(100.0f, infillDensity * (float)pow(2, level));
+
+        if (infillType == InfillType::Diagonal) {
+            // the spacing of the diagonal pattern goes with one over the density squared,
+            // so the density goes up by the square root of two to halve the spacing, up to lines that touch
+            float solidDensity = 100 * 2 * nozzleDiameter / sqrt(sqrt(2) * nozzleDiameter);
+            density = min(solidDensity, infillDensity * (float)pow(2, level / 2.0));
+            gradualDensity.push_back(density);
+            CreateDiagonalInfill(density, settings);
+            gradualInfill.push_back(infill);
+            gradualSpacing.push_back(infillSpacing);
+        } else {
+            gradualDensity.push_back(density);
+            gradualSpacing.push_back(InfillPattern::GetTile(infillType, density, nozzleDiameter).spacing);
+        }
+    }
+
+    infill = baseInfill;
+    infillSpacing = baseSpacing;
+}
+
+Clipper2Lib::PathsD CreateInfill::CreateScanlines(Clipper2Lib::RectD bounds, double spacing, double angle){
+    Clipper2Lib::PathsD lines;
+    if (!bounds.IsValid() || bounds.IsEmpty() || spacing <= 0) {
+        return lines;
+    }
+
+    // parallel lines at the given angle (radians) that cover the bounds, lines are anchored at the origin so they line up between layers
+    double dx = cos(angle);
+    double dy = sin(angle);
+    Clipper2Lib::PointD center = bounds.MidPoint();
+    double radius = sqrt(bounds.Width() * bounds.Width() + bounds.Height() * bounds.Height()) / 2;
+    double along = center.x * dx + center.y * dy;
+    double across = -center.x * dy + center.y * dx;
+
+    int first = (int)floor((across - radius) / spacing);
+    int last = (int)ceil((across + radius) / spacing);
+    for (int i = first; i <= last; i++) {
+        double offset = i * spacing;
+        Clipper2Lib::PathD line;
+        line.push_back(Clipper2Lib::PointD((along - radius) * dx - offset * dy, (along - radius) * dy + offset * dx));
+        line.push_back(Clipper2Lib::PointD((along + radius) * dx - offset * dy, (along + radius) * dy + offset * dx));
+        lines.push_back(line);
+    }
+
+    return lines;
+}
+
+Clipper2Lib::PathsD CreateInfill::GetInfill(Clipper2Lib::RectD bounds, int level){
+    if (infillType == InfillType::Diagonal) {
+        return CullDiagonal(level == 0 ? infill : gradualInfill[level - 1], GetInfillSpacing(level) * sqrt(2), bounds);
+    }
+
+    float density = level == 0 ? infillDensity : gradualDensity[level - 1];
+    return InfillPattern::Instantiate(infillType, density, nozzleDiameter, bounds);
+}
+
+Clipper2Lib::PathsD CreateInfill::CullDiagonal(Clipper2Lib::PathsD &lines, double step, Clipper2Lib::RectD bounds){
+    // the diagonal pattern is stored for the whole plate, line i is step * i away from the origin along the axis it crosses,
+    // so the lines that can cross the bounds are found by their index instead of by going over every line of the plate
+    // the order is the order of CreateDiagonalInfill: i = 0 going up and going down, then per i: up +i, up -i, down +i, down -i
+    Clipper2Lib::PathsD culled;
+    int count = (lines.size() + 2) / 4;
+    if (lines.size() == 0 || step <= 0) {
+        return culled;
+    }
+
+    // a line going up has a constant y - x, a line going down a constant y + x, those have to fall within the bounds
+    double up[2] = {bounds.top - bounds.right, bounds.bottom - bounds.left};
+    double down[2] = {bounds.top + bounds.left, bounds.bottom + bounds.right};
+    vector<int> indices;
+    for (int kind = 0; kind < 4; kind++) {
+        double *range = kind < 2 ? up : down;
+        double sign = kind % 2 == 0 ? 1 : -1;
+
+        // the lines of this kind that can fall within the range, with one line of slack for rounding
+        double from = sign > 0 ? range[0] / step : -range[1] / step;
+        double to = sign > 0 ? range[1] / step : -range[0] / step;
+        int first = max(kind % 2 == 0 ? 0 : 1, (int)floor(from) - 1);
+        int last = min(count - 1, (int)ceil(to) + 1);
+        for (int i = first; i <= last; i++) {
+            int index = i == 0 ? kind / 2 : 2 + 4 * (i - 1) + kind;
+            if (index >= lines.size()) {
+                continue;
+            }
+            Clipper2Lib::PointD start = lines[index][0];
+            double offset = kind < 2 ? start.y - start.x : start.y + start.x;
+            if (offset >= range[0] && offset <= range[1]) {
+                indices.push_back(index);
+            }
+        }
+    }
+
+    sort(indices.begin(), indices.end());
+    for (int index : indices) {
+        culled.push_back(lines[index]);
+    }
+    return culled;
+}
+
 Clipper2Lib::PathsD CreateInfill::ClipInfill(Clipper2Lib::PathsD &infill, Clipper2Lib::PathsD &Clip){
+    Clipper2Lib::PathsD clippedInfill;
+    if (infill.size() == 0 || Clip.size() == 0) {
+        return clippedInfill;
+    }
+
+    // phase 1: cull the pattern against the bounding rectangle of every island, this is linear in the amount of lines
+    vector<int> islands;
+    vector<Clipper2Lib::RectD> islandBounds;
+    vector<Clipper2Lib::RectD> holeBounds;
+    for (int i = 0; i < Clip.size(); i++) {
+        if (Clipper2Lib::IsPositive(Clip[i])) {
+            islands.push_back(i);
+            islandBounds.push_back(Clipper2Lib::GetBounds(Clip[i]));
+        } else {
+            holeBounds.push_back(Clipper2Lib::GetBounds(Clip[i]));
+        }
+    }
+
+    bool disjoint = true;
+    for (int i = 0; i < islandBounds.size() && disjoint; i++) {
+        for (int j = i + 1; j < islandBounds.size(); j++) {
+            if (islandBounds[i].Intersects(islandBounds[j])) {
+                disjoint = false;
+                break;
+            }
+        }
+    }
+
+    Clipper2Lib::PathsD culled;
+    if (disjoint) {
+        for (int i = 0; i < islands.size(); i++) {
+            Clipper2Lib::PathsD islandLines = Clipper2Lib::RectClipLines(islandBounds[i], infill);
+
+            // an axis aligned rectangle without holes is its own bounding box, the culled lines are final
+            bool hasHoles = false;
+            for (Clipper2Lib::RectD &hole : holeBounds) {
+                if (islandBounds[i].Intersects(hole)) {
+                    hasHoles = true;
+                    break;
+                }
+            }
+            if (!hasHoles && IsAxisAlignedRectangle(Clip[islands[i]], islandBounds[i])) {
+                clippedInfill.insert(clippedInfill.end(), islandLines.begin(), islandLines.end());
+            } else {
+                culled.insert(culled.end(), islandLines.begin(), islandLines.end());
+            }
+        }
+    } else {
+        culled = Clipper2Lib::RectClipLines(Clipper2Lib::GetBounds(Clip), infill);
+    }
+
+    if (culled.size() == 0) {
+        return clippedInfill;
+    }
+
+    // phase 2: full polygon intersection on the lines that survived
     Clipper2Lib::ClipperD clipper;
     Clipper2Lib::PathsD clippedTmp;
-    Clipper2Lib::PathsD clippedInfill;
-    clipper.AddOpenSubject(infill);
+    Clipper2Lib::PathsD clippedLines;
+    clipper.AddOpenSubject(culled);
     clipper.AddClip(Clip);
-    clipper.Execute(Clipper2Lib::ClipType::Intersection, Clipper2Lib::FillRule::EvenOdd, clippedTmp, clippedInfill);
+    clipper.Execute(Clipper2Lib::ClipType::Intersection, Clipper2Lib::FillRule::EvenOdd, clippedTmp, clippedLines);
     clipper.Clear();
 
+    clippedInfill.insert(clippedInfill.end(), clippedLines.begin(), clippedLines.end());
     return clippedInfill;
 }
 
+bool CreateInfill::IsAxisAlignedRectangle(Clipper2Lib::PathD &path, Clipper2Lib::RectD &bounds){
+    if (path.size() != 4) {
+        return false;
+    }
+    // every corner of the path has to be a corner of its bounding box
+    for (Clipper2Lib::PointD &point : path) {
+        bool onX = abs(point.x - bounds.left) < 1e-9 || abs(point.x - bounds.right) < 1e-9;
+        bool onY = abs(point.y - bounds.top) < 1e-9 || abs(point.y - bounds.bottom) < 1e-9;
+        if (!onX || !onY) {
+            return false;
+        }
+    }
+    return abs(abs(Clipper2Lib::Area(path)) - bounds.Width() * bounds.Height()) < 1e-6;
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,213 @@
+#ifndef INFILLPATTERN_HPP
+#define INFILLPATTERN_HPP
+
+#include <map>
+#include <tuple>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include "clipper2/clipper.h"
+#include "../../SlicerSettings/SlicerSettings.hpp"
+
+// one period of a repeating infill pattern, lines are in tile coordinates [0, width] x [0, height]
+struct PatternTile
+{
+    double width;
+    double height;
+    double spacing; //distance between neighbouring parallel lines
+    Clipper2Lib::PathsD lines;
+};
+
+// periodic infill patterns: every pattern is defined as a single tile that is cached per density and nozzle width,
+// a layer only instantiates the tiles overlapping the area it has to fill
+class InfillPattern
+{
+private:
+    static PatternTile CreateHoneycombTile(float density, float nozzleDiameter);
+    static PatternTile CreateTriangleTile(float density, float nozzleDiameter);
+
+    static Clipper2Lib::PathsD StitchLines(Clipper2Lib::PathsD &lines);
+    static int64_t PointKey(Clipper2Lib::PointD point) { return (int64_t)(((uint64_t)llround(point.x * 10000) << 32) ^ (uint32_t)llround(point.y * 10000)); }
+
+public:
+    static const PatternTile &GetTile(InfillType type, float density, float nozzleDiameter);
+    static Clipper2Lib::PathsD Instantiate(InfillType type, float density, float nozzleDiameter, Clipper2Lib::RectD bounds);
+};
+
+const PatternTile &InfillPattern::GetTile(InfillType type, float density, float nozzleDiameter)
+{
+    // tiles are shared by every layer and every object, std::map keeps references valid when new tiles are added
+    static std::map<std::tuple<int, float, float>, PatternTile> tileCache;
+
+    std::tuple<int, float, float> key = std::make_tuple((int)type, density, nozzleDiameter);
+    const PatternTile *tile;
+#pragma omp critical(infillTileCache)
+    {
+        auto cached = tileCache.find(key);
+        if (cached == tileCache.end())
+        {
+            PatternTile newTile = type == InfillType::Honeycomb ? CreateHoneycombTile(density, nozzleDiameter) : CreateTriangleTile(density, nozzleDiameter);
+            cached = tileCache.emplace(key, newTile).first;
+        }
+        tile = &cached->second;
+    }
+    return *tile;
+}
+
+Clipper2Lib::PathsD InfillPattern::Instantiate(InfillType type, float density, float nozzleDiameter, Clipper2Lib::RectD bounds)
+{
+    Clipper2Lib::PathsD lines;
+    if (!bounds.IsValid() || bounds.IsEmpty())
+    {
+        return lines;
+    }
+
+    const PatternTile &tile = GetTile(type, density, nozzleDiameter);
+
+    // tiles are anchored at the origin so the pattern lines up between layers
+    int minX = (int)floor(bounds.left / tile.width);
+    int maxX = (int)floor(bounds.right / tile.width);
+    int minY = (int)floor(bounds.top / tile.height);
+    int maxY = (int)floor(bounds.bottom / tile.height);
+
+    lines.reserve((maxX - minX + 1) * (maxY - minY + 1) * tile.lines.size());
+    for (int y = minY; y <= maxY; y++)
+    {
+        for (int x = minX; x <= maxX; x++)
+        {
+            for (const Clipper2Lib::PathD &line : tile.lines)
+            {
+                lines.push_back(Clipper2Lib::TranslatePath(line, x * tile.width, y * tile.height));
+            }
+        }
+    }
+
+    // join the pieces of neighbouring tiles so clipping works on long lines
+    return StitchLines(lines);
+}
+
+PatternTile InfillPattern::CreateHoneycombTile(float density, float nozzleDiameter)
+{
+    //convert density to a percentage
+    density = density / 100;
+
+    // flat topped hexagons with side s, drawn as two mirrored zig-zags per row that touch along the flat sides
+    // each zig-zag is 4s long per tile of 3s * sqrt(3)s
+    // density = nozzleDiameter * 8s / (3*sqrt(3) * s^2) -> s = 8 * nozzleDiameter / (3*sqrt(3) * density)
+    double s = 8 * nozzleDiameter / (3 * sqrt(3) * density);
+    double h = sqrt(3) * s;
+    // shared sides are printed twice, half a line width to each side
+    double o = nozzleDiameter / 2;
+
+    PatternTile tile;
+    tile.width = 3 * s;
+    tile.height = h;
+    tile.spacing = h / 2;
+
+    tile.lines.push_back({Clipper2Lib::PointD(0.0, h / 2 - o), Clipper2Lib::PointD(s / 2, h / 2 - o), Clipper2Lib::PointD(s, o),
+                          Clipper2Lib::PointD(2 * s, o), Clipper2Lib::PointD(2.5 * s, h / 2 - o), Clipper2Lib::PointD(3 * s, h / 2 - o)});
+    tile.lines.push_back({Clipper2Lib::PointD(0.0, h / 2 + o), Clipper2Lib::PointD(s / 2, h / 2 + o), Clipper2Lib::PointD(s, h - o),
+                          Clipper2Lib::PointD(2 * s, h - o), Clipper2Lib::PointD(2.5 * s, h / 2 + o), Clipper2Lib::PointD(3 * s, h / 2 + o)});
+
+    return tile;
+}
+
+PatternTile InfillPattern::CreateTriangleTile(float density, float nozzleDiameter)
+{
+    //convert density to a percentage
+    density = density / 100;
+
+    // three families of parallel lines (0, 60 and 120 degrees), each at distance d
+    // density = 3 * nozzleDiameter / d
+    double d = 3 * nozzleDiameter / density;
+    double a = 2 * d / sqrt(3);
+
+    PatternTile tile;
+    tile.width = a;
+    tile.height = 2 * d;
+    tile.spacing = d;
+
+    tile.lines.push_back({Clipper2Lib::PointD(0.0, 0.0), Clipper2Lib::PointD(a, 0.0)});
+    tile.lines.push_back({Clipper2Lib::PointD(0.0, d), Clipper2Lib::PointD(a, d)});
+    tile.lines.push_back({Clipper2Lib::PointD(0.0, 0.0), Clipper2Lib::PointD(a, 2 * d)});
+    tile.lines.push_back({Clipper2Lib::PointD(a, 0.0), Clipper2Lib::PointD(0.0, 2 * d)});
+
+    return tile;
+}
+
+Clipper2Lib::PathsD InfillPattern::StitchLines(Clipper2Lib::PathsD &lines)
+{
+    // every endpoint that is shared by two pieces gets joined
+    unordered_map<int64_t, vector<int>> endPoints;
+    endPoints.reserve(lines.size() * 2);
+    for (int i = 0; i < lines.size(); i++)
+    {
+        endPoints[PointKey(lines[i].front())].push_back(i);
+        endPoints[PointKey(lines[i].back())].push_back(i);
+    }
+
+    vector<bool> used(lines.size(), false);
+    Clipper2Lib::PathsD stitched;
+    for (int i = 0; i < lines.size(); i++)
+    {
+        if (used[i])
+        {
+            continue;
+        }
+        used[i] = true;
+        Clipper2Lib::PathD path = lines[i];
+
+        // extend the end of the path, then flip it and extend the other end
+        for (int side = 0; side < 2; side++)
+        {
+            while (true)
+            {
+                // prefer the piece that continues straight on, so lines stay straight through shared vertices
+                Clipper2Lib::PointD end = path.back();
+                Clipper2Lib::PointD previous = path[path.size() - 2];
+                double length = sqrt(pow(end.x - previous.x, 2) + pow(end.y - previous.y, 2));
+                int best = -1;
+                bool bestReversed = false;
+                double bestAlignment = -2;
+                for (int candidate : endPoints[PointKey(end)])
+                {
+                    if (used[candidate])
+                    {
+                        continue;
+                    }
+                    bool reversed = PointKey(lines[candidate].front()) != PointKey(end);
+                    Clipper2Lib::PointD next = reversed ? lines[candidate][lines[candidate].size() - 2] : lines[candidate][1];
+                    double nextLength = sqrt(pow(next.x - end.x, 2) + pow(next.y - end.y, 2));
+                    double alignment = ((end.x - previous.x) * (next.x - end.x) + (end.y - previous.y) * (next.y - end.y)) / (length * nextLength);
+                    if (alignment > bestAlignment)
+                    {
+                        bestAlignment = alignment;
+                        best = candidate;
+                        bestReversed = reversed;
+                    }
+                }
+                if (best == -1)
+                {
+                    break;
+                }
+
+                used[best] = true;
+                if (bestReversed)
+                {
+                    path.insert(path.end(), lines[best].rbegin() + 1, lines[best].rend());
+                }
+                else
+                {
+                    path.insert(path.end(), lines[best].begin() + 1, lines[best].end());
+                }
+            }
+            std::reverse(path.begin(), path.end());
+        }
+        stitched.push_back(path);
+    }
+
+    return stitched;
+}
+
+#endif
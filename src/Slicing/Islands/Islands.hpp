@@ -0,0 +1,52 @@
+#ifndef ISLANDS_HPP
+#define ISLANDS_HPP
+
+#include <vector>
+#include "clipper2/clipper.h"
+
+// splits a layer into its islands: one outer contour with its holes, islands inside holes are islands of their own
+class Islands
+{
+public:
+    static vector<Clipper2Lib::PathsD> Split(const Clipper2Lib::PathsD &paths, Clipper2Lib::FillRule fillRule = Clipper2Lib::FillRule::NonZero);
+};
+
+vector<Clipper2Lib::PathsD> Islands::Split(const Clipper2Lib::PathsD &paths, Clipper2Lib::FillRule fillRule)
+{
+    vector<Clipper2Lib::PathsD> islands;
+    if (paths.size() == 0)
+    {
+        return islands;
+    }
+
+    Clipper2Lib::PolyTreeD tree;
+    Clipper2Lib::ClipperD clipper(3);
+    clipper.AddSubject(paths);
+    clipper.Execute(Clipper2Lib::ClipType::Union, fillRule, tree);
+
+    vector<const Clipper2Lib::PolyPathD *> outers;
+    for (const auto &child : tree)
+    {
+        outers.push_back(child.get());
+    }
+
+    for (int o = 0; o < outers.size(); o++)
+    {
+        Clipper2Lib::PathsD island;
+        island.push_back(outers[o]->Polygon());
+        for (const auto &hole : *outers[o])
+        {
+            island.push_back(hole->Polygon());
+            // islands inside holes are handled on their own
+            for (const auto &inner : *hole)
+            {
+                outers.push_back(inner.get());
+            }
+        }
+        islands.push_back(island);
+    }
+
+    return islands;
+}
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef MODIFIER_HPP
+#define MODIFIER_HPP
+
+#include <vector>
+#include <cmath>
+#include <clipper2/clipper.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "../../Mesh/Mesh.hpp"
+#include "../../SlicerSettings/SlicerSettings.hpp"
+#include "../TriangleIntersections/CalculateIntersections.hpp"
+
+// a volume that changes the settings of the part of a mesh inside it, the volume itself is never printed
+struct Modifier
+{
+    vector<Vertex> vertices;
+    glm::mat4 transform = glm::mat4(1.0f); //places the volume in the space of the mesh resting on the bed, centered on the origin
+    int shells;
+    float infill;
+    int surfaces; //roofs and floors inside the volume
+};
+
+// the regions of the modifiers in every layer of a mesh
+// a mesh can have several modifiers, where they overlap the last one wins so the regions of a layer never overlap
+class Modifiers
+{
+public:
+    static vector<Vertex> Box(glm::vec3 size);
+    static vector<Vertex> Cylinder(float radius, float height, int segments = 32);
+    static vector<vector<Clipper2Lib::PathsD>> SliceRegions(const vector<Modifier> &modifiers, vector<Clipper2Lib::PathsD> &layers, vector<double> &heights, SlicerSettings &settings);
+    static Clipper2Lib::PathsD Combine(Clipper2Lib::PathsD &outside, vector<Clipper2Lib::PathsD> &inside, vector<Clipper2Lib::PathsD> &regions);
+};
+
+vector<Vertex> Modifiers::Box(glm::vec3 size)
+{
+    // centered on the origin, standing on the bed
+    glm::vec3 low(-size.x / 2, -size.y / 2, 0.0f);
+    glm::vec3 high(size.x / 2, size.y / 2, size.z);
+    glm::vec3 corners[8];
+    for (int c = 0; c < 8; c++)
+    {
+        corners[c] = glm::vec3(c & 1 ? high.x : low.x, c & 2 ? high.y : low.y, c & 4 ? high.z : low.z);
+    }
+
+    // two triangles per face, wound counter clockwise seen from the outside
+    int faces[6][4] = {{0, 2, 3, 1}, {4, 5, 7, 6}, {0, 1, 5, 4}, {2, 6, 7, 3}, {0, 4, 6, 2}, {1, 3, 7, 5}};
+    vector<Vertex> vertices;
+    for (int f = 0; f < 6; f++)
+    {
+        int order[6] = {0, 1, 2, 0, 2, 3};
+        for (int k = 0; k < 6; k++)
+        {
+            Vertex vertex;
+            vertex.Position = corners[faces[f][order[k]]];
+            vertices.push_back(vertex);
+        }
+    }
+    return vertices;
+}
+
+vector<Vertex> Modifiers::Cylinder(float radius, float height, int segments)
+{
+    // centered on the origin, standing on the bed, the round side is split in segments
+    vector<Vertex> vertices;
+    auto add = [&vertices](glm::vec3 a, glm::vec3 b, glm::vec3 c) {
+        for (glm::vec3 position : {a, b, c})
+        {
+            Vertex vertex;
+            vertex.Position = position;
+            vertices.push_back(vertex);
+        }
+    };
+    glm::vec3 bottom(0.0f, 0.0f, 0.0f);
+    glm::vec3 top(0.0f, 0.0f, height);
+    for (int s = 0; s < segments; s++)
+    {
+        double a0 = 2 * M_PI * s / segments;
+        double a1 = 2 * M_PI * (s + 1) / segments;
+        glm::vec3 p0(radius * cos(a0), radius * sin(a0), 0.0f);
+        glm::vec3 p1(radius * cos(a1), radius * sin(a1), 0.0f);
+        glm::vec3 q0 = p0 + top;
+        glm::vec3 q1 = p1 + top;
+        add(bottom, p1, p0);
+        add(top, q0, q1);
+        add(p0, p1, q1);
+        add(p0, q1, q0);
+    }
+    return vertices;
+}
+
+vector<vector<Clipper2Lib::PathsD>> Modifiers::SliceRegions(const vector<Modifier> &modifiers, vector<Clipper2Lib::PathsD> &layers, vector<double> &heights, SlicerSettings &settings)
+{
+    // regions[layer][modifier], only the part of a modifier that lies inside the layer is kept
+    vector<vector<Clipper2Lib::PathsD>> regions(layers.size(), vector<Clipper2Lib::PathsD>(modifiers.size()));
+    for (int m = 0; m < modifiers.size(); m++)
+    {
+        vector<Vertex> vertices = modifiers[m].vertices;
+        #pragma omp parallel for
+        for (int v = 0; v < vertices.size(); v++)
+        {
+            vertices[v].Position = glm::vec3(modifiers[m].transform * glm::vec4(vertices[v].Position, 1.0f));
+        }
+
+        #pragma omp parallel for schedule(dynamic)
+        for (int i = 0; i < layers.size(); i++)
+        {
+            Clipper2Lib::PathsD volume = CalculateIntersections::CalculateClipperPaths(vertices, settings, heights[i]);
+            if (volume.size() > 0)
+            {
+                regions[i][m] = Clipper2Lib::Intersect(layers[i], volume, Clipper2Lib::FillRule::EvenOdd);
+            }
+        }
+    }
+
+    // a later modifier takes its region out of the earlier ones
+    #pragma omp parallel for
+    for (int i = 0; i < layers.size(); i++)
+    {
+        for (int m = modifiers.size() - 1; m > 0; m--)
+        {
+            if (regions[i][m].size() == 0)
+            {
+                continue;
+            }
+            for (int earlier = 0; earlier < m; earlier++)
+            {
+                if (regions[i][earlier].size() > 0)
+                {
+                    regions[i][earlier] = Clipper2Lib::Difference(regions[i][earlier], regions[i][m], Clipper2Lib::FillRule::NonZero);
+                }
+            }
+        }
+    }
+    return regions;
+}
+
+Clipper2Lib::PathsD Modifiers::Combine(Clipper2Lib::PathsD &outside, vector<Clipper2Lib::PathsD> &inside, vector<Clipper2Lib::PathsD> &regions)
+{
+    // the area of the regular settings outside every region, and the area of each modifier inside its own region
+    Clipper2Lib::PathsD combined = outside;
+    for (int m = 0; m < regions.size(); m++)
+    {
+        if (regions[m].size() == 0)
+        {
+            continue;
+        }
+        combined = Clipper2Lib::Difference(combined, regions[m], Clipper2Lib::FillRule::NonZero);
+    }
+    for (int m = 0; m < regions.size(); m++)
+    {
+        if (regions[m].size() == 0 || inside[m].size() == 0)
+        {
+            continue;
+        }
+        Clipper2Lib::PathsD part = Clipper2Lib::Intersect(inside[m], regions[m], Clipper2Lib::FillRule::NonZero);
+        combined = Clipper2Lib::Union(combined, part, Clipper2Lib::FillRule::NonZero);
+    }
+    return combined;
+}
+
+#endif
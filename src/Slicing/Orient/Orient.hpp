@@ -0,0 +1,244 @@
+#ifndef ORIENT_HPP
+#define ORIENT_HPP
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "../../Mesh/Mesh.hpp"
+#include "../../SlicerSettings/SlicerSettings.hpp"
+
+// finds the rotation that puts a mesh on the bed with the least support and the lowest height
+// every candidate is scored straight from the triangles: the area facing down steeper than the support angle,
+// the volume below it, the area that lies on the bed and the height of the part
+class Orient
+{
+private:
+    // structure of arrays so the scoring loops vectorize
+    struct Triangles
+    {
+        vector<float> normalX, normalY, normalZ;
+        vector<float> centerX, centerY, centerZ;
+        vector<float> area;
+        vector<float> pointX, pointY, pointZ; //every corner, for the height of the part
+    };
+
+    static const int clusters = 16; //largest groups of faces with the same normal, every group is tried flat on the bed
+    static const int samples = 100; //directions spread evenly over the sphere
+
+    static Triangles Prepare(const vector<Vertex> &vertices, const glm::mat4 &transform);
+    static vector<glm::vec3> Candidates(Triangles &triangles);
+    static double Cost(Triangles &triangles, glm::vec3 down, SlicerSettings &settings);
+    static glm::mat3 RotationTo(glm::vec3 down);
+
+public:
+    static glm::mat3 FindOrientation(const vector<Vertex> &vertices, SlicerSettings &settings, const glm::mat4 &transform = glm::mat4(1.0f));
+};
+
+glm::mat3 Orient::FindOrientation(const vector<Vertex> &vertices, SlicerSettings &settings, const glm::mat4 &transform)
+{
+    // the returned rotation goes on top of the transform
+    Triangles triangles = Prepare(vertices, transform);
+    vector<glm::vec3> candidates = Candidates(triangles);
+
+    vector<double> costs(candidates.size());
+    #pragma omp parallel for schedule(dynamic)
+    for (int c = 0; c < candidates.size(); c++)
+    {
+        costs[c] = Cost(triangles, candidates[c], settings);
+    }
+
+    // the current orientation is the first candidate, another one has to be clearly better to turn the part
+    int best = 0;
+    for (int c = 1; c < candidates.size(); c++)
+    {
+        if (costs[c] < costs[best] - abs(costs[0]) * 0.01)
+        {
+            best = c;
+        }
+    }
+    return RotationTo(candidates[best]);
+}
+
+Orient::Triangles Orient::Prepare(const vector<Vertex> &vertices, const glm::mat4 &transform)
+{
+    // the normals are computed from the corners, the normals in the file are not always right
+    int n = vertices.size() / 3;
+    Triangles triangles;
+    triangles.normalX.resize(n);
+    triangles.normalY.resize(n);
+    triangles.normalZ.resize(n);
+    triangles.centerX.resize(n);
+    triangles.centerY.resize(n);
+    triangles.centerZ.resize(n);
+    triangles.area.resize(n);
+    triangles.pointX.resize(n * 3);
+    triangles.pointY.resize(n * 3);
+    triangles.pointZ.resize(n * 3);
+
+    double volume = 0;
+    #pragma omp parallel for reduction(+:volume)
+    for (int t = 0; t < n; t++)
+    {
+        glm::vec3 a = glm::vec3(transform * glm::vec4(vertices[t * 3].Position, 1.0f));
+        glm::vec3 b = glm::vec3(transform * glm::vec4(vertices[t * 3 + 1].Position, 1.0f));
+        glm::vec3 c = glm::vec3(transform * glm::vec4(vertices[t * 3 + 2].Position, 1.0f));
+        glm::vec3 cross = glm::cross(b - a, c - a);
+        float length = glm::length(cross);
+        glm::vec3 normal = length > 0 ? cross / length : glm::vec3(0.0f);
+        glm::vec3 center = (a + b + c) / 3.0f;
+
+        triangles.normalX[t] = normal.x;
+        triangles.normalY[t] = normal.y;
+        triangles.normalZ[t] = normal.z;
+        triangles.centerX[t] = center.x;
+        triangles.centerY[t] = center.y;
+        triangles.centerZ[t] = center.z;
+        triangles.area[t] = length / 2;
+        volume += glm::dot(a, cross) / 6;
+        glm::vec3 corners[3] = {a, b, c};
+        for (int k = 0; k < 3; k++)
+        {
+            triangles.pointX[t * 3 + k] = corners[k].x;
+            triangles.pointY[t * 3 + k] = corners[k].y;
+            triangles.pointZ[t * 3 + k] = corners[k].z;
+        }
+    }
+
+    // a mesh with a negative volume has its triangles wound the other way, the normals point inwards
+    if (volume < 0)
+    {
+        for (int t = 0; t < n; t++)
+        {
+            triangles.normalX[t] = -triangles.normalX[t];
+            triangles.normalY[t] = -triangles.normalY[t];
+            triangles.normalZ[t] = -triangles.normalZ[t];
+        }
+    }
+    return triangles;
+}
+
+vector<glm::vec3> Orient::Candidates(Triangles &triangles)
+{
+    // a candidate is the direction of the mesh that ends up pointing down, the current orientation goes first
+    vector<glm::vec3> candidates = {glm::vec3(0.0f, 0.0f, -1.0f)};
+
+    // flat faces: the normals are binned per 10 degrees of latitude and longitude, weighted by area
+    const int latitudeBins = 18;
+    const int longitudeBins = 36;
+    vector<glm::dvec3> binNormals(latitudeBins * longitudeBins, glm::dvec3(0.0));
+    vector<double> binAreas(latitudeBins * longitudeBins, 0.0);
+    for (int t = 0; t < triangles.area.size(); t++)
+    {
+        if (triangles.area[t] == 0)
+        {
+            continue;
+        }
+        double latitude = acos(max(-1.0f, min(1.0f, triangles.normalZ[t])));
+        double longitude = atan2(triangles.normalY[t], triangles.normalX[t]) + M_PI;
+        int latitudeBin = min(latitudeBins - 1, (int)(latitude / M_PI * latitudeBins));
+        int longitudeBin = min(longitudeBins - 1, (int)(longitude / (2 * M_PI) * longitudeBins));
+        int bin = latitudeBin * longitudeBins + longitudeBin;
+        binNormals[bin] += glm::dvec3(triangles.normalX[t], triangles.normalY[t], triangles.normalZ[t]) * (double)triangles.area[t];
+        binAreas[bin] += triangles.area[t];
+    }
+
+    vector<int> bins(binAreas.size());
+    for (int b = 0; b < bins.size(); b++)
+    {
+        bins[b] = b;
+    }
+    sort(bins.begin(), bins.end(), [&binAreas](int a, int b) {
+        return binAreas[a] > binAreas[b];
+    });
+    for (int k = 0; k < clusters && k < bins.size() && binAreas[bins[k]] > 0; k++)
+    {
+        if (glm::length(binNormals[bins[k]]) > 0)
+        {
+            candidates.push_back(glm::vec3(glm::normalize(binNormals[bins[k]])));
+        }
+    }
+
+    // directions that no face points in: a fibonacci sphere
+    double goldenAngle = M_PI * (3 - sqrt(5.0));
+    for (int k = 0; k < samples; k++)
+    {
+        double z = 1 - 2 * (k + 0.5) / samples;
+        double radius = sqrt(1 - z * z);
+        candidates.push_back(glm::vec3(radius * cos(goldenAngle * k), radius * sin(goldenAngle * k), z));
+    }
+    return candidates;
+}
+
+double Orient::Cost(Triangles &triangles, glm::vec3 down, SlicerSettings &settings)
+{
+    glm::vec3 up = -down;
+    float lowest = INFINITY;
+    float highest = -INFINITY;
+    int points = triangles.pointX.size();
+    const float *pointX = triangles.pointX.data();
+    const float *pointY = triangles.pointY.data();
+    const float *pointZ = triangles.pointZ.data();
+    #pragma omp simd reduction(min:lowest) reduction(max:highest)
+    for (int p = 0; p < points; p++)
+    {
+        float height = up.x * pointX[p] + up.y * pointY[p] + up.z * pointZ[p];
+        lowest = min(lowest, height);
+        highest = max(highest, height);
+    }
+
+    // a face needs support when it is further from vertical than the support angle, a face on the bed is carried by the bed
+    float threshold = sin(settings.GetSupportAngle() * M_PI / 180);
+    float bedHeight = settings.GetLayerHeight();
+    double overhang = 0;
+    double supportVolume = 0;
+    double contact = 0;
+    int n = triangles.area.size();
+    const float *normalX = triangles.normalX.data();
+    const float *normalY = triangles.normalY.data();
+    const float *normalZ = triangles.normalZ.data();
+    const float *centerX = triangles.centerX.data();
+    const float *centerY = triangles.centerY.data();
+    const float *centerZ = triangles.centerZ.data();
+    const float *area = triangles.area.data();
+    #pragma omp simd reduction(+:overhang, supportVolume, contact)
+    for (int t = 0; t < n; t++)
+    {
+        float facing = down.x * normalX[t] + down.y * normalY[t] + down.z * normalZ[t];
+        float height = up.x * centerX[t] + up.y * centerY[t] + up.z * centerZ[t] - lowest;
+        float projected = area[t] * facing;
+        bool onBed = height < bedHeight;
+        bool unsupported = facing > threshold && !onBed;
+        overhang += unsupported ? projected : 0.0f;
+        supportVolume += unsupported ? projected * height : 0.0f;
+        contact += facing > threshold && onBed ? projected : 0.0f;
+    }
+
+    // everything is weighed in mm3 of material: the support at its density, the dense interface below the overhangs,
+    // a layer of 10 mm2 for every mm of height as the time spent on layer changes and one layer of the area on the bed as a reward
+    double height = highest - lowest;
+    double density = settings.GetSupportDensity() / 100;
+    double interface = max(1, settings.GetSupportInterfaceLayers()) * settings.GetLayerHeight();
+    return supportVolume * density + overhang * interface + height * 10 - contact * settings.GetLayerHeight();
+}
+
+glm::mat3 Orient::RotationTo(glm::vec3 down)
+{
+    // the rotation that turns the given direction to point straight down
+    glm::vec3 target(0.0f, 0.0f, -1.0f);
+    float cosine = glm::dot(down, target);
+    if (cosine > 0.99999f)
+    {
+        return glm::mat3(1.0f);
+    }
+    if (cosine < -0.99999f)
+    {
+        // upside down, half a turn around the x axis
+        return glm::mat3(glm::rotate(glm::mat4(1.0f), (float)M_PI, glm::vec3(1.0f, 0.0f, 0.0f)));
+    }
+    glm::vec3 axis = glm::normalize(glm::cross(down, target));
+    return glm::mat3(glm::rotate(glm::mat4(1.0f), acos(cosine), axis));
+}
+
+#endif
@@ -0,0 +1,262 @@
+#ifndef SLABSLICER_HPP
+#define SLABSLICER_HPP
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <random>
+#include <filesystem>
+#include <functional>
+#include "clipper2/clipper.h"
+#include "../Slicing.hpp"
+
+// slices stl files that are too large to load, the triangles never are in memory all at once
+// the file is streamed twice: once for its bounds and once to sort the triangles into slabs of layers on disk,
+// a triangle that spans several slabs is written to every slab it touches
+// the slabs are then sliced one by one, only the triangles of one slab and the contours of the layers are kept in memory
+class SlabSlicer
+{
+private:
+    struct Triangle
+    {
+        float corners[9];
+    };
+
+    // the slabs live in a directory of their own, it is removed however slicing ends
+    struct SlabDirectory
+    {
+        filesystem::path path;
+        ~SlabDirectory()
+        {
+            error_code error;
+            filesystem::remove_all(path, error);
+        }
+    };
+
+    static const int chunkTriangles = 65536; //triangles read from the file at once
+    static const int bufferFloats = 65536; //floats kept per slab before they are appended to its file
+
+    static bool ReadTriangles(const string &path, const function<void(Triangle &)> &callback);
+    static bool ReadBinary(ifstream &file, uint32_t count, const function<void(Triangle &)> &callback);
+    static bool ReadAscii(ifstream &file, const function<void(Triangle &)> &callback);
+    static void Flush(const filesystem::path &slabPath, vector<float> &buffer);
+
+public:
+    static bool SliceFile(const string &path, SlicerSettings settings, vector<Slice> &slices);
+};
+
+bool SlabSlicer::SliceFile(const string &path, SlicerSettings settings, vector<Slice> &slices)
+{
+    // returns false when the file can not be read, a file without layers gives no slices
+    // first pass: the bounds, the part is placed on the bed with its bounding box centered like a loaded mesh
+    glm::vec3 lowest(INFINITY);
+    glm::vec3 highest(-INFINITY);
+    bool read = ReadTriangles(path, [&lowest, &highest](Triangle &triangle) {
+        for (int k = 0; k < 3; k++)
+        {
+            glm::vec3 corner(triangle.corners[k * 3], triangle.corners[k * 3 + 1], triangle.corners[k * 3 + 2]);
+            lowest = glm::min(lowest, corner);
+            highest = glm::max(highest, corner);
+        }
+    });
+    slices.clear();
+    if (!read)
+    {
+        return false;
+    }
+    if (lowest.z > highest.z)
+    {
+        return true;
+    }
+    glm::vec3 shift(-(lowest.x + highest.x) / 2, -(lowest.y + highest.y) / 2, -lowest.z);
+
+    // the layers are cut halfway their height, just like a mesh in memory
+    double layerHeight = settings.GetLayerHeight();
+    int layerCount = (int)ceil((highest.z - lowest.z) / layerHeight - 0.5);
+    if (layerCount <= 0)
+    {
+        return true;
+    }
+    int slabLayers = max(1, settings.GetSlabLayers());
+    int slabCount = (layerCount + slabLayers - 1) / slabLayers;
+
+    // second pass: every triangle goes to the slabs of the layers it crosses
+    random_device random;
+    SlabDirectory directory = {filesystem::temp_directory_path() / ("zupaslica_slabs_" + to_string(random()))};
+    filesystem::create_directories(directory.path);
+    vector<filesystem::path> slabPaths(slabCount);
+    for (int s = 0; s < slabCount; s++)
+    {
+        slabPaths[s] = directory.path / (to_string(s) + ".bin");
+        ofstream(slabPaths[s], ios::binary);
+    }
+    vector<vector<float>> buffers(slabCount);
+    read = ReadTriangles(path, [&](Triangle &triangle) {
+        float bottom = INFINITY;
+        float top = -INFINITY;
+        for (int k = 0; k < 3; k++)
+        {
+            triangle.corners[k * 3] += shift.x;
+            triangle.corners[k * 3 + 1] += shift.y;
+            triangle.corners[k * 3 + 2] += shift.z;
+            bottom = min(bottom, triangle.corners[k * 3 + 2]);
+            top = max(top, triangle.corners[k * 3 + 2]);
+        }
+        int first = max(0, (int)ceil(bottom / layerHeight - 0.5));
+        int last = min(layerCount - 1, (int)floor(top / layerHeight - 0.5));
+        if (first > last)
+        {
+            return;
+        }
+        for (int s = first / slabLayers; s <= last / slabLayers; s++)
+        {
+            buffers[s].insert(buffers[s].end(), triangle.corners, triangle.corners + 9);
+            if (buffers[s].size() >= bufferFloats)
+            {
+                Flush(slabPaths[s], buffers[s]);
+            }
+        }
+    });
+    // a file that can not be read to the end would give layers with parts missing
+    if (!read)
+    {
+        return false;
+    }
+    for (int s = 0; s < slabCount; s++)
+    {
+        Flush(slabPaths[s], buffers[s]);
+    }
+
+    // every slab is loaded and sliced on its own, its layers are sliced in parallel
+    // the corners are kept as they are on disk, three floats each
+    slices.resize(layerCount);
+    for (int s = 0; s < slabCount; s++)
+    {
+        vector<glm::vec3> corners;
+        {
+            ifstream slabFile(slabPaths[s], ios::binary | ios::ate);
+            size_t floats = slabFile.tellg() / sizeof(float);
+            corners.resize(floats / 3);
+            slabFile.seekg(0);
+            if (!slabFile.read((char *)corners.data(), corners.size() * sizeof(glm::vec3)))
+            {
+                return false;
+            }
+        }
+        filesystem::remove(slabPaths[s]);
+
+        int slabEnd = min(layerCount, (s + 1) * slabLayers);
+        #pragma omp parallel for schedule(dynamic)
+        for (int i = s * slabLayers; i < slabEnd; i++)
+        {
+            slices[i].height = layerHeight * (i + 0.5);
+            slices[i].paths = CalculateIntersections::CalculateClipperPaths(corners, settings, slices[i].height);
+        }
+    }
+
+    // like a mesh in memory, the part ends at the first empty layer
+    for (int i = 0; i < slices.size(); i++)
+    {
+        if (slices[i].paths.size() == 0)
+        {
+            slices.resize(i);
+            break;
+        }
+    }
+
+    // from here on the layers go through the same pipeline as any other mesh
+    slices = Slicing::SliceLayers(slices, settings);
+    Slicing::AddSupports(slices, settings);
+    Slicing::AddAdhesion(slices, settings);
+    return true;
+}
+
+void SlabSlicer::Flush(const filesystem::path &slabPath, vector<float> &buffer)
+{
+    if (buffer.size() == 0)
+    {
+        return;
+    }
+    ofstream slabFile(slabPath, ios::binary | ios::app);
+    slabFile.write((const char *)buffer.data(), buffer.size() * sizeof(float));
+    buffer.clear();
+}
+
+bool SlabSlicer::ReadTriangles(const string &path, const function<void(Triangle &)> &callback)
+{
+    // a binary stl is an 80 byte header, a triangle count and 50 bytes per triangle, anything else is read as ascii
+    // some exporters write bytes after the last triangle, those files are binary as long as the header does not start like ascii
+    ifstream file(path, ios::binary | ios::ate);
+    if (!file)
+    {
+        return false;
+    }
+    size_t size = file.tellg();
+    file.seekg(0);
+    char header[80];
+    uint32_t count = 0;
+    if (size >= 84)
+    {
+        file.read(header, 80);
+        file.read((char *)&count, sizeof(count));
+        size_t expected = 84 + (size_t)count * 50;
+        if (size == expected || (size > expected && strncmp(header, "solid", 5) != 0))
+        {
+            return ReadBinary(file, count, callback);
+        }
+    }
+    file.clear();
+    file.seekg(0);
+    return ReadAscii(file, callback);
+}
+
+bool SlabSlicer::ReadBinary(ifstream &file, uint32_t count, const function<void(Triangle &)> &callback)
+{
+    // every triangle is a normal, three corners and two attribute bytes, the normal is not used
+    vector<char> chunk((size_t)chunkTriangles * 50);
+    Triangle triangle;
+    for (uint32_t done = 0; done < count;)
+    {
+        uint32_t amount = min((uint32_t)chunkTriangles, count - done);
+        if (!file.read(chunk.data(), (size_t)amount * 50))
+        {
+            return false;
+        }
+        for (uint32_t t = 0; t < amount; t++)
+        {
+            memcpy(triangle.corners, chunk.data() + (size_t)t * 50 + 12, sizeof(triangle.corners));
+            callback(triangle);
+        }
+        done += amount;
+    }
+    return true;
+}
+
+bool SlabSlicer::ReadAscii(ifstream &file, const function<void(Triangle &)> &callback)
+{
+    // only the vertex lines matter, every three of them make a triangle
+    Triangle triangle;
+    int corner = 0;
+    bool found = false;
+    string word;
+    while (file >> word)
+    {
+        if (word != "vertex")
+        {
+            continue;
+        }
+        file >> triangle.corners[corner * 3] >> triangle.corners[corner * 3 + 1] >> triangle.corners[corner * 3 + 2];
+        if (++corner == 3)
+        {
+            callback(triangle);
+            corner = 0;
+            found = true;
+        }
+    }
+    return found;
+}
+
+#endif
@@ -0,0 +1,326 @@
+#ifndef ARRANGE_HPP
+#define ARRANGE_HPP
+
+#include <vector>
+#include <map>
+#include <tuple>
+#include <cmath>
+#include <algorithm>
+#include "clipper2/clipper.h"
+#include "../../SlicerSettings/SlicerSettings.hpp"
+#include "Plate.hpp"
+#include "../Walls/ShellLadder.hpp"
+
+// packs the instances on the plate with bottom left fill on no fit polygons
+// the footprint of a part is its silhouette grown by half the spacing, two footprints may touch but not overlap
+// the no fit polygon of two footprints holds every position of the second one where it overlaps the first one,
+// it only depends on the shapes and rotations so it is computed once for every pair of meshes and reused for every instance
+class Arrange
+{
+private:
+    typedef tuple<int, double, int, double> PairKey; //placed object and rotation, new object and rotation
+
+    struct Part
+    {
+        int object;
+        int instance;
+        double area;
+    };
+
+    struct Placed
+    {
+        int part;
+        int object;
+        double rotation;
+        Clipper2Lib::PointD position;
+    };
+
+    struct Candidate
+    {
+        bool fits;
+        Clipper2Lib::PointD position;
+    };
+
+    static const int rotations = 4; //every part is tried at quarter turns from its current rotation
+
+    static Clipper2Lib::PathsD Silhouette(vector<Vertex> &vertices, const glm::mat4 &transform);
+    static Clipper2Lib::PathsD Rotate(const Clipper2Lib::PathsD &paths, double rotation);
+    static Clipper2Lib::PathsD NoFitPolygon(Clipper2Lib::PathsD &placed, Clipper2Lib::PathsD &part);
+    static Candidate BottomLeft(Clipper2Lib::PathsD &part, vector<Clipper2Lib::PathsD> &noFitPolygons, Clipper2Lib::RectD bed);
+
+public:
+    static int ArrangePlate(vector<PlateObject> &objects, SlicerSettings &settings);
+};
+
+int Arrange::ArrangePlate(vector<PlateObject> &objects, SlicerSettings &settings)
+{
+    // the brim or raft is part of the footprint, it is printed on the plate as well
+    double margin = settings.GetArrangeSpacing() / 2;
+    if (settings.GetRaft().enabled)
+    {
+        margin += settings.GetRaft().margin;
+    }
+    else if (settings.GetBrim().enabled)
+    {
+        margin += settings.GetBrim().lines * settings.GetNozzleDiameter();
+    }
+
+    // the footprints are simplified to keep the no fit polygons small, they are grown by the tolerance first so they stay around the silhouette
+    double tolerance = 0.2;
+    vector<Clipper2Lib::PathsD> footprints(objects.size());
+    for (int o = 0; o < objects.size(); o++)
+    {
+        if (objects[o].placements.size() > 0)
+        {
+            footprints[o] = ShellLadder::Offset(Silhouette(objects[o].vertices, objects[o].transform), margin + tolerance, Clipper2Lib::JoinType::Round);
+            footprints[o] = Clipper2Lib::SimplifyPaths(footprints[o], tolerance);
+        }
+    }
+
+    // the biggest parts go first, small parts fill the gaps they leave
+    vector<Part> parts;
+    for (int o = 0; o < objects.size(); o++)
+    {
+        for (int k = 0; k < objects[o].placements.size(); k++)
+        {
+            parts.push_back({o, k, Clipper2Lib::Area(footprints[o])});
+        }
+    }
+    stable_sort(parts.begin(), parts.end(), [](const Part &a, const Part &b) {
+        return a.area > b.area;
+    });
+
+    BuildVolume volume = settings.GetBuildVolume();
+    Clipper2Lib::RectD bed(-volume.x / 2, -volume.y / 2, volume.x / 2, volume.y / 2);
+    map<pair<int, double>, Clipper2Lib::PathsD> rotatedFootprints;
+    map<PairKey, Clipper2Lib::PathsD> noFitPolygons;
+    vector<Placed> placed;
+    int unplaced = 0;
+
+    for (int p = 0; p < parts.size(); p++)
+    {
+        Part &part = parts[p];
+        Placement &placement = objects[part.object].placements[part.instance];
+        double rotation[rotations];
+        for (int r = 0; r < rotations; r++)
+        {
+            rotation[r] = fmod(placement.rotation + r * 90, 360);
+            pair<int, double> key(part.object, rotation[r]);
+            if (rotatedFootprints.find(key) == rotatedFootprints.end())
+            {
+                rotatedFootprints[key] = Rotate(footprints[part.object], rotation[r]);
+            }
+        }
+
+        // no fit polygons that are not known yet, every pair is computed in parallel
+        vector<PairKey> missing;
+        for (Placed &other : placed)
+        {
+            for (int r = 0; r < rotations; r++)
+            {
+                PairKey key(other.object, other.rotation, part.object, rotation[r]);
+                if (noFitPolygons.find(key) == noFitPolygons.end() && find(missing.begin(), missing.end(), key) == missing.end())
+                {
+                    missing.push_back(key);
+                }
+            }
+        }
+        vector<Clipper2Lib::PathsD> computed(missing.size());
+        #pragma omp parallel for schedule(dynamic)
+        for (int m = 0; m < missing.size(); m++)
+        {
+            Clipper2Lib::PathsD &placedFootprint = rotatedFootprints.at({get<0>(missing[m]), get<1>(missing[m])});
+            Clipper2Lib::PathsD &partFootprint = rotatedFootprints.at({get<2>(missing[m]), get<3>(missing[m])});
+            computed[m] = NoFitPolygon(placedFootprint, partFootprint);
+        }
+        for (int m = 0; m < missing.size(); m++)
+        {
+            noFitPolygons[missing[m]] = computed[m];
+        }
+
+        // every rotation is evaluated in parallel against the parts that are already placed
+        vector<Candidate> candidates(rotations);
+        #pragma omp parallel for
+        for (int r = 0; r < rotations; r++)
+        {
+            vector<Clipper2Lib::PathsD> blocked;
+            for (Placed &other : placed)
+            {
+                Clipper2Lib::PathsD &noFitPolygon = noFitPolygons.at(PairKey(other.object, other.rotation, part.object, rotation[r]));
+                blocked.push_back(Clipper2Lib::TranslatePaths(noFitPolygon, other.position.x, other.position.y));
+            }
+            candidates[r] = BottomLeft(rotatedFootprints.at({part.object, rotation[r]}), blocked, bed);
+        }
+
+        int best = -1;
+        for (int r = 0; r < rotations; r++)
+        {
+            if (!candidates[r].fits)
+            {
+                continue;
+            }
+            if (best == -1 || candidates[r].position.y < candidates[best].position.y ||
+                (candidates[r].position.y == candidates[best].position.y && candidates[r].position.x < candidates[best].position.x))
+            {
+                best = r;
+            }
+        }
+
+        // a part that does not fit keeps its place, the caller can warn about it
+        if (best == -1)
+        {
+            unplaced++;
+            continue;
+        }
+        placement = {candidates[best].position.x, candidates[best].position.y, rotation[best]};
+        placed.push_back({p, part.object, rotation[best], candidates[best].position});
+    }
+
+    // the parts are packed against the front left corner, the whole group is moved to the center of the bed
+    if (placed.size() > 0)
+    {
+        Clipper2Lib::PathsD all;
+        for (Placed &other : placed)
+        {
+            Clipper2Lib::PathsD footprint = Clipper2Lib::TranslatePaths(rotatedFootprints[{other.object, other.rotation}], other.position.x, other.position.y);
+            all.insert(all.end(), footprint.begin(), footprint.end());
+        }
+        Clipper2Lib::RectD bounds = Clipper2Lib::GetBounds(all);
+        Clipper2Lib::PointD shift(-(bounds.left + bounds.right) / 2, -(bounds.top + bounds.bottom) / 2);
+        for (Placed &other : placed)
+        {
+            Placement &placement = objects[parts[other.part].object].placements[parts[other.part].instance];
+            placement.x += shift.x;
+            placement.y += shift.y;
+        }
+    }
+    return unplaced;
+}
+
+Clipper2Lib::PathsD Arrange::Silhouette(vector<Vertex> &vertices, const glm::mat4 &transform)
+{
+    // the union of every triangle seen from above, the triangles are merged per chunk in parallel
+    int triangles = vertices.size() / 3;
+    int chunkSize = 4096;
+    int chunks = (triangles + chunkSize - 1) / chunkSize;
+    vector<Clipper2Lib::PathsD> merged(chunks);
+    #pragma omp parallel for schedule(dynamic)
+    for (int c = 0; c < chunks; c++)
+    {
+        Clipper2Lib::PathsD projected;
+        for (int t = c * chunkSize; t < min(triangles, (c + 1) * chunkSize); t++)
+        {
+            Clipper2Lib::PathD triangle;
+            for (int k = 0; k < 3; k++)
+            {
+                glm::vec4 position = transform * glm::vec4(vertices[t * 3 + k].Position, 1.0f);
+                triangle.push_back(Clipper2Lib::PointD(position.x, position.y));
+            }
+            // triangles facing down are seen from below, vertical triangles have no area
+            if (!Clipper2Lib::IsPositive(triangle))
+            {
+                reverse(triangle.begin(), triangle.end());
+            }
+            projected.push_back(triangle);
+        }
+        merged[c] = Clipper2Lib::Union(projected, Clipper2Lib::FillRule::NonZero);
+    }
+
+    Clipper2Lib::PathsD all;
+    for (Clipper2Lib::PathsD &chunk : merged)
+    {
+        all.insert(all.end(), chunk.begin(), chunk.end());
+    }
+    all = Clipper2Lib::Union(all, Clipper2Lib::FillRule::NonZero);
+
+    // holes in the silhouette are too small to hold other parts in practice, only the outer contours are kept
+    Clipper2Lib::PathsD silhouette;
+    for (Clipper2Lib::PathD &path : all)
+    {
+        if (Clipper2Lib::IsPositive(path))
+        {
+            silhouette.push_back(path);
+        }
+    }
+    return silhouette;
+}
+
+Clipper2Lib::PathsD Arrange::Rotate(const Clipper2Lib::PathsD &paths, double rotation)
+{
+    double angle = rotation * M_PI / 180;
+    double cosine = cos(angle);
+    double sine = sin(angle);
+    Clipper2Lib::PathsD rotated(paths.size());
+    for (int i = 0; i < paths.size(); i++)
+    {
+        for (const Clipper2Lib::PointD &point : paths[i])
+        {
+            rotated[i].push_back(Clipper2Lib::PointD(point.x * cosine - point.y * sine, point.x * sine + point.y * cosine));
+        }
+    }
+    return rotated;
+}
+
+Clipper2Lib::PathsD Arrange::NoFitPolygon(Clipper2Lib::PathsD &placed, Clipper2Lib::PathsD &part)
+{
+    // the difference of the contours sweeps the part around the boundary of the placed footprint,
+    // the area inside that band overlaps as well so only its outer contours are kept
+    Clipper2Lib::PathsD band;
+    for (Clipper2Lib::PathD &placedPath : placed)
+    {
+        for (Clipper2Lib::PathD &partPath : part)
+        {
+            Clipper2Lib::PathsD sweep = Clipper2Lib::MinkowskiDiff(partPath, placedPath, true);
+            band.insert(band.end(), sweep.begin(), sweep.end());
+        }
+    }
+    band = Clipper2Lib::Union(band, Clipper2Lib::FillRule::NonZero);
+
+    Clipper2Lib::PathsD noFitPolygon;
+    for (Clipper2Lib::PathD &path : band)
+    {
+        if (Clipper2Lib::IsPositive(path))
+        {
+            noFitPolygon.push_back(path);
+        }
+    }
+    return Clipper2Lib::Union(noFitPolygon, Clipper2Lib::FillRule::NonZero);
+}
+
+Arrange::Candidate Arrange::BottomLeft(Clipper2Lib::PathsD &part, vector<Clipper2Lib::PathsD> &noFitPolygons, Clipper2Lib::RectD bed)
+{
+    // the positions that keep the part on the bed form a rectangle, the no fit polygons are cut out of it
+    Clipper2Lib::RectD bounds = Clipper2Lib::GetBounds(part);
+    Clipper2Lib::RectD inside(bed.left - bounds.left, bed.top - bounds.top, bed.right - bounds.right, bed.bottom - bounds.bottom);
+    if (inside.left > inside.right || inside.top > inside.bottom)
+    {
+        return {false, Clipper2Lib::PointD(0, 0)};
+    }
+
+    Clipper2Lib::PathsD free = {inside.AsPath()};
+    if (noFitPolygons.size() > 0)
+    {
+        Clipper2Lib::PathsD blocked;
+        for (Clipper2Lib::PathsD &noFitPolygon : noFitPolygons)
+        {
+            blocked.insert(blocked.end(), noFitPolygon.begin(), noFitPolygon.end());
+        }
+        free = Clipper2Lib::Difference(free, blocked, Clipper2Lib::FillRule::NonZero);
+    }
+
+    // the lowest free position is a corner of the free area, ties go to the left
+    Candidate candidate = {false, Clipper2Lib::PointD(0, 0)};
+    for (Clipper2Lib::PathD &path : free)
+    {
+        for (Clipper2Lib::PointD &point : path)
+        {
+            if (!candidate.fits || point.y < candidate.position.y || (point.y == candidate.position.y && point.x < candidate.position.x))
+            {
+                candidate = {true, point};
+            }
+        }
+    }
+    return candidate;
+}
+
+#endif
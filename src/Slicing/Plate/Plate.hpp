@@ -0,0 +1,223 @@
+#ifndef PLATE_HPP
+#define PLATE_HPP
+
+#include <vector>
+#include <cmath>
+#include "clipper2/clipper.h"
+#include "../Slicing.hpp"
+
+// where one instance of a mesh is put on the plate, relative to the center of the bed
+struct Placement
+{
+    double x;
+    double y;
+    double rotation; //degrees around the z axis
+};
+
+// a mesh and every copy of it on the plate
+struct PlateObject
+{
+    vector<Vertex> vertices;
+    vector<Placement> placements;
+    glm::mat4 transform = glm::mat4(1.0f); //puts the vertices on the bed, applied when the mesh is sliced
+    vector<Modifier> modifiers; //volumes with other settings, placed on the mesh after its transform
+};
+
+// slices a plate with multiple objects that can each be placed multiple times
+// a mesh is only sliced once, the layers of its instances are copies that are moved into place
+// an instance can only be moved and turned around the z axis, any other rotation changes the layers and needs its own mesh
+class Plate
+{
+private:
+    struct Instance
+    {
+        int object;
+        Placement placement;
+    };
+
+    static Slice Transform(Slice &slice, const Placement &placement);
+    static Clipper2Lib::PathD Transform(const Clipper2Lib::PathD &path, const Placement &placement);
+    static Clipper2Lib::PathsD Transform(const Clipper2Lib::PathsD &paths, const Placement &placement);
+    static vector<VariableWidthPath> Transform(const vector<VariableWidthPath> &paths, const Placement &placement);
+    static void Append(Slice &layer, Slice &instance);
+    static vector<Instance> OrderInstances(vector<PlateObject> &objects);
+
+public:
+    static vector<Slice> SlicePlate(vector<PlateObject> &objects, SlicerSettings settings);
+};
+
+vector<Slice> Plate::SlicePlate(vector<PlateObject> &objects, SlicerSettings settings)
+{
+    // every mesh is sliced once, a few meshes are each sliced in parallel internally,
+    // when there are at least as many meshes as threads (a file split in its bodies) the meshes are sliced side by side instead
+    vector<vector<Slice>> meshSlices(objects.size());
+    #pragma omp parallel for schedule(dynamic) if (objects.size() >= omp_get_max_threads())
+    for (int o = 0; o < objects.size(); o++)
+    {
+        if (objects[o].placements.size() > 0)
+        {
+            meshSlices[o] = Slicing::SliceMesh(objects[o].vertices, settings, objects[o].transform, objects[o].modifiers);
+        }
+    }
+
+    // all meshes are sliced at the same heights, layer i of every mesh ends up in layer i of the plate
+    int layerCount = 0;
+    for (vector<Slice> &slices : meshSlices)
+    {
+        layerCount = max(layerCount, (int)slices.size());
+    }
+    vector<Instance> instances = OrderInstances(objects);
+
+    // the layers are placed in parallel, every instance is moved into place and added to its layer right away,
+    // so only one moved copy per thread exists at a time
+    // instances are added to a layer in the order they are visited, the walls of a layer are printed in that order
+    vector<Slice> plate(layerCount);
+    #pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < layerCount; i++)
+    {
+        for (int k = 0; k < instances.size(); k++)
+        {
+            vector<Slice> &slices = meshSlices[instances[k].object];
+            if (i < slices.size())
+            {
+                Slice placed = Transform(slices[i], instances[k].placement);
+                plate[i].height = slices[i].height;
+                Append(plate[i], placed);
+            }
+        }
+    }
+
+    // supports and adhesion go around everything on the plate, not around a single instance
+    Slicing::AddSupports(plate, settings);
+    Slicing::AddAdhesion(plate, settings);
+    return plate;
+}
+
+vector<Plate::Instance> Plate::OrderInstances(vector<PlateObject> &objects)
+{
+    vector<Instance> remaining;
+    for (int o = 0; o < objects.size(); o++)
+    {
+        for (Placement &placement : objects[o].placements)
+        {
+            remaining.push_back({o, placement});
+        }
+    }
+
+    // nearest neighbour from the front left of the bed, where the purge line ends
+    vector<Instance> ordered;
+    Clipper2Lib::PointD position(-INFINITY, -INFINITY);
+    while (remaining.size() > 0)
+    {
+        int closest = 0;
+        double closestDistance = INFINITY;
+        for (int k = 0; k < remaining.size(); k++)
+        {
+            double distance = isinf(position.x) ? remaining[k].placement.x + remaining[k].placement.y
+                                                : sqrt(pow(remaining[k].placement.x - position.x, 2) + pow(remaining[k].placement.y - position.y, 2));
+            if (distance < closestDistance)
+            {
+                closestDistance = distance;
+                closest = k;
+            }
+        }
+        position = Clipper2Lib::PointD(remaining[closest].placement.x, remaining[closest].placement.y);
+        ordered.push_back(remaining[closest]);
+        remaining.erase(remaining.begin() + closest);
+    }
+    return ordered;
+}
+
+Slice Plate::Transform(Slice &slice, const Placement &placement)
+{
+    Slice placed;
+    placed.height = slice.height;
+    placed.paths = Transform(slice.paths, placement);
+    placed.outerWall = Transform(slice.outerWall, placement);
+    placed.thinWalls = Transform(slice.thinWalls, placement);
+    placed.infillBoundary = Transform(slice.infillBoundary, placement);
+    placed.innerWall = Transform(slice.innerWall, placement);
+    for (Clipper2Lib::PathsD &shell : slice.shells)
+    {
+        placed.shells.push_back(Transform(shell, placement));
+    }
+    placed.partialShells = Transform(slice.partialShells, placement);
+    placed.gapFill = Transform(slice.gapFill, placement);
+    placed.infill = Transform(slice.infill, placement);
+    placed.combinedInfill = Transform(slice.combinedInfill, placement);
+    placed.combinedInfillLayers = slice.combinedInfillLayers;
+    placed.surfaceWall = Transform(slice.surfaceWall, placement);
+    placed.surface = Transform(slice.surface, placement);
+    placed.bridges = Transform(slice.bridges, placement);
+    placed.ironing = Transform(slice.ironing, placement);
+    return placed;
+}
+
+Clipper2Lib::PathD Plate::Transform(const Clipper2Lib::PathD &path, const Placement &placement)
+{
+    // a rotation keeps the orientation of the contours, holes stay holes
+    double angle = placement.rotation * M_PI / 180;
+    double cosine = cos(angle);
+    double sine = sin(angle);
+    Clipper2Lib::PathD transformed;
+    transformed.reserve(path.size());
+    for (const Clipper2Lib::PointD &point : path)
+    {
+        transformed.push_back(Clipper2Lib::PointD(point.x * cosine - point.y * sine + placement.x,
+                                                  point.x * sine + point.y * cosine + placement.y));
+    }
+    return transformed;
+}
+
+Clipper2Lib::PathsD Plate::Transform(const Clipper2Lib::PathsD &paths, const Placement &placement)
+{
+    Clipper2Lib::PathsD transformed(paths.size());
+    for (int i = 0; i < paths.size(); i++)
+    {
+        transformed[i] = Transform(paths[i], placement);
+    }
+    return transformed;
+}
+
+vector<VariableWidthPath> Plate::Transform(const vector<VariableWidthPath> &paths, const Placement &placement)
+{
+    vector<VariableWidthPath> transformed(paths.size());
+    for (int i = 0; i < paths.size(); i++)
+    {
+        transformed[i].path = Transform(paths[i].path, placement);
+        transformed[i].widths = paths[i].widths;
+    }
+    return transformed;
+}
+
+void Plate::Append(Slice &layer, Slice &instance)
+{
+    layer.paths.insert(layer.paths.end(), instance.paths.begin(), instance.paths.end());
+    layer.outerWall.insert(layer.outerWall.end(), instance.outerWall.begin(), instance.outerWall.end());
+    layer.thinWalls.insert(layer.thinWalls.end(), instance.thinWalls.begin(), instance.thinWalls.end());
+    layer.infillBoundary.insert(layer.infillBoundary.end(), instance.infillBoundary.begin(), instance.infillBoundary.end());
+    layer.innerWall.insert(layer.innerWall.end(), instance.innerWall.begin(), instance.innerWall.end());
+    if (layer.shells.size() < instance.shells.size())
+    {
+        layer.shells.resize(instance.shells.size());
+    }
+    for (int k = 0; k < instance.shells.size(); k++)
+    {
+        layer.shells[k].insert(layer.shells[k].end(), instance.shells[k].begin(), instance.shells[k].end());
+    }
+    layer.partialShells.insert(layer.partialShells.end(), instance.partialShells.begin(), instance.partialShells.end());
+    layer.gapFill.insert(layer.gapFill.end(), instance.gapFill.begin(), instance.gapFill.end());
+    layer.infill.insert(layer.infill.end(), instance.infill.begin(), instance.infill.end());
+    // combined infill groups start at the first layer for every mesh, groups that end on the same layer have the same thickness
+    if (instance.combinedInfill.size() > 0)
+    {
+        layer.combinedInfill.insert(layer.combinedInfill.end(), instance.combinedInfill.begin(), instance.combinedInfill.end());
+        layer.combinedInfillLayers = instance.combinedInfillLayers;
+    }
+    layer.surfaceWall.insert(layer.surfaceWall.end(), instance.surfaceWall.begin(), instance.surfaceWall.end());
+    layer.surface.insert(layer.surface.end(), instance.surface.begin(), instance.surface.end());
+    layer.bridges.insert(layer.bridges.end(), instance.bridges.begin(), instance.bridges.end());
+    layer.ironing.insert(layer.ironing.end(), instance.ironing.begin(), instance.ironing.end());
+}
+
+#endif
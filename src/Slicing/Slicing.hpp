@@ -2,46 +2,94 @@
 #define slicing_H
 #include <clipper2/clipper.h>
 #include <vector>
+#include <map>
 #include "../Mesh/Mesh.hpp"
+#include "../Mesh/MeshBounds.hpp"
 #include "TriangleIntersections/CalculateIntersections.hpp"
 #include "Infill/CreateInfill.hpp"
+#include "Infill/ConnectInfill.hpp"
 #include "../SlicerSettings/SlicerSettings.hpp"
 #include "Surface/Surface.hpp"
+#include "Surface/Bridges.hpp"
+#include "Support/Support.hpp"
+#include "Support/TreeSupport.hpp"
+#include "Adhesion/Adhesion.hpp"
+#include "Walls/VariableWidthWalls.hpp"
+#include "Walls/ShellLadder.hpp"
+#include "Walls/Decimation.hpp"
+#include "Islands/Islands.hpp"
+#include "Modifier/Modifier.hpp"
 #include "omp.h"
 
 struct Slice
 {
     double height;
     Clipper2Lib::PathsD paths;
-    vector<Clipper2Lib::PathsD> skirt;
+    vector<Clipper2Lib::PathsD> skirt; //skirt and brim loops
+    Clipper2Lib::PathsD raft; //lines of a raft layer, raft layers have nothing else
     Clipper2Lib::PathsD outerWall;
+    vector<VariableWidthPath> thinWalls; //single lines for the parts that are too thin for the outer wall
+    Clipper2Lib::PathsD infillBoundary; //inner wall offsetted by one line, infill and surfaces are clipped to this area
     Clipper2Lib::PathsD innerWall; //inner wall is a part of shell, but is not considered in the printing process, it is just the last shell, but it is easier to reference like this when clipping the infill
     std::vector<Clipper2Lib::PathsD> shells;
+    vector<VariableWidthPath> partialShells; //pieces of shells that end at the border of a modifier, printed as open lines
+    vector<VariableWidthPath> gapFill; //lines in the gaps between walls that are too narrow for another wall
     Clipper2Lib::PathsD infill;
+    Clipper2Lib::PathsD combinedInfill; //sparse infill printed for multiple layers at once, only on the top layer of a group
+    int combinedInfillLayers = 1;
     Clipper2Lib::PathsD surfaceWall;
     Clipper2Lib::PathsD surface;
-    std::vector<Clipper2Lib::PathsD> roofAdjacences;
-    std::vector<Clipper2Lib::PathsD> floorAdjacences;
+    Clipper2Lib::PathsD bridges; //surface lines over empty space, printed with their own speed and flow
+    Clipper2Lib::PathsD ironing; //dense low flow lines over the top surfaces, printed last
+    Clipper2Lib::PathsD support; //sparse lines below overhangs
+    Clipper2Lib::PathsD supportInterface; //dense lines at the top of the support, the overhang is printed on these
 };
 
 class Slicing 
 {
 private:
+    static Slice CreateWalls(Clipper2Lib::PathsD &island, SlicerSettings &settings);
+    static void ApplyModifierShells(Slice &slice, vector<Clipper2Lib::PathsD> &regions, const vector<Modifier> &modifiers, SlicerSettings &settings);
+    static vector<VariableWidthPath> CreateGapFill(Slice &slice, Clipper2Lib::PathsD &offsettedInnerWall, SlicerSettings &settings, Clipper2Lib::PathsD *area = nullptr);
+    static Clipper2Lib::PathsD CreateIroning(CreateInfill &infillCreator, Clipper2Lib::PathsD &surfaceArea, Clipper2Lib::PathsD *layerAbove, int layer, SlicerSettings &settings);
+    static Clipper2Lib::PathsD CreateSparseInfill(CreateInfill &infillCreator, Clipper2Lib::PathsD &clipArea, vector<Clipper2Lib::PathsD> &roofDistances, SlicerSettings &settings);
 public:
     static vector<Slice> SliceModel(vector<Vertex> model, SlicerSettings settings);
+    static vector<Slice> SliceMesh(vector<Vertex> model, SlicerSettings settings, glm::mat4 transform = glm::mat4(1.0f), const vector<Modifier> &modifiers = vector<Modifier>());
+    static vector<Slice> SliceLayers(vector<Slice> slices, SlicerSettings settings, const vector<Modifier> &modifiers = vector<Modifier>());
+    static void AddSupports(vector<Slice> &slices, SlicerSettings &settings);
+    static void AddAdhesion(vector<Slice> &slices, SlicerSettings &settings);
 };
 
 vector<Slice> Slicing::SliceModel(vector<Vertex> model, SlicerSettings settings) {
-    float layerHeight = settings.GetLayerHeight();
-    settings.SetSlicingPlaneHeight(layerHeight / 2);
+    vector<Slice> slices = SliceMesh(model, settings);
+    AddSupports(slices, settings);
+    AddAdhesion(slices, settings);
+    return slices;
+}
 
-    CreateInfill infillCreator;
+// walls, surfaces and infill of one mesh, these only depend on the mesh itself
+// supports and adhesion depend on everything else that is on the plate, they are added afterwards
+vector<Slice> Slicing::SliceMesh(vector<Vertex> model, SlicerSettings settings, glm::mat4 transform, const vector<Modifier> &modifiers) {
+    // the model is a copy, the transform of the object is applied to it once instead of rewriting the loaded mesh
+    if (transform != glm::mat4(1.0f))
+    {
+        #pragma omp parallel for
+        for (int i = 0; i < model.size(); i++)
+        {
+            model[i].Position = glm::vec3(transform * glm::vec4(model[i].Position, 1.0f));
+        }
+    }
 
-    // make infill once, then retrieve it for each slice
-    infillCreator.CreateDiagonalInfill(settings.GetInfill(), settings);
-    infillCreator.CreateSurfaceInfill(0, settings);
-    infillCreator.CreateSurfaceInfill(1, settings);
+    float layerHeight = settings.GetLayerHeight();
+    settings.SetSlicingPlaneHeight(layerHeight / 2);
 
+    // a body of a file can start above the bed, its layers below it are empty so its layers line up with the rest of the plate
+    if (model.size() == 0)
+    {
+        return vector<Slice>();
+    }
+    double bottom = MeshBounds::Calculate(model).lowest.z;
 
     vector<Slice> slices;
     bool nonEmpty = true;
@@ -52,7 +100,7 @@ vector<Slice> Slicing::SliceModel(vector<Vertex> model, SlicerSettings settings)
         settings.SetSlicingPlaneHeight(intersectionHeight + layerHeight);
 
         Clipper2Lib::PathsD paths = CalculateIntersections::CalculateClipperPaths(model, settings, intersectionHeight);
-        if (paths.size() == 0)
+        if (paths.size() == 0 && intersectionHeight > bottom)
         {
             nonEmpty = false;
         }
@@ -76,105 +124,699 @@ vector<Slice> Slicing::SliceModel(vector<Vertex> model, SlicerSettings settings)
         return a.height == b.height;
         }), slices.end());
 
-#pragma omp parallel for
-    for (int i = 0; i < slices.size(); i++) {
-        Slice slice = slices[i];
-        Clipper2Lib::PathsD paths = slice.paths;
-        //erode outerWall by half the nozzle diameter
-        paths = Clipper2Lib::InflatePaths(paths, -settings.GetNozzleDiameter() / 2, Clipper2Lib::JoinType::Miter, Clipper2Lib::EndType::Polygon, 3);
-        paths = Clipper2Lib::SimplifyPaths(paths, 0.00125);
-        slice.outerWall = paths;
-        slice.innerWall = paths;
+    return SliceLayers(slices, settings, modifiers);
+}
 
+// everything after the contours: the contours can come from a mesh in memory or from a file that is sliced in slabs
+vector<Slice> Slicing::SliceLayers(vector<Slice> slices, SlicerSettings settings, const vector<Modifier> &modifiers) {
+    CreateInfill infillCreator;
+
+    // make infill once, then retrieve it for each slice
+    infillCreator.CreatePatternInfill(settings.GetInfillType(), settings.GetInfill(), settings);
+    infillCreator.CreateGradualInfill(settings.GetGradualInfillSteps(), settings);
+    infillCreator.CreateSurfaceInfill(0, settings);
+    infillCreator.CreateSurfaceInfill(1, settings);
+
+    // walls are created per island, the islands of all layers are spread over the threads so a layer with many islands is not handled by one thread
+    vector<vector<Clipper2Lib::PathsD>> layerIslands(slices.size());
+    #pragma omp parallel for
+    for (int i = 0; i < slices.size(); i++)
+    {
+        layerIslands[i] = Islands::Split(slices[i].paths, Clipper2Lib::FillRule::EvenOdd);
+    }
 
-        //add inner shells
-        std::vector<Clipper2Lib::PathsD> shells;
-        Clipper2Lib::PathsD lastPaths = paths;
-        for (int i = 0; i < settings.GetShells() - 1; i++)
+    vector<pair<int, int>> islandItems;
+    for (int i = 0; i < slices.size(); i++)
+    {
+        for (int k = 0; k < layerIslands[i].size(); k++)
         {
-            Clipper2Lib::PathsD shellPaths = Clipper2Lib::InflatePaths(lastPaths, -settings.GetNozzleDiameter(), Clipper2Lib::JoinType::Miter, Clipper2Lib::EndType::Polygon);
-            shellPaths = Clipper2Lib::SimplifyPaths(shellPaths, 0.00125);
-            lastPaths = shellPaths;
-            shells.push_back(shellPaths);
+            islandItems.push_back({i, k});
         }
-        slice.shells = shells;
-
-        //set inner wall
-        slice.innerWall = lastPaths;
+    }
 
-        slice.infill = Clipper2Lib::PathsD();
+    vector<Slice> islandWalls(islandItems.size());
+    #pragma omp parallel for schedule(dynamic)
+    for (int w = 0; w < islandItems.size(); w++)
+    {
+        islandWalls[w] = CreateWalls(layerIslands[islandItems[w].first][islandItems[w].second], settings);
+    }
 
-        slices[i] = slice;
+    // islands are merged back into their layer in order
+    for (int w = 0; w < islandItems.size(); w++)
+    {
+        Slice &slice = slices[islandItems[w].first];
+        Slice &island = islandWalls[w];
+        slice.outerWall.insert(slice.outerWall.end(), island.outerWall.begin(), island.outerWall.end());
+        slice.thinWalls.insert(slice.thinWalls.end(), island.thinWalls.begin(), island.thinWalls.end());
+        slice.innerWall.insert(slice.innerWall.end(), island.innerWall.begin(), island.innerWall.end());
+        slice.infillBoundary.insert(slice.infillBoundary.end(), island.infillBoundary.begin(), island.infillBoundary.end());
+        if (slice.shells.size() < island.shells.size())
+        {
+            slice.shells.resize(island.shells.size());
+        }
+        for (int k = 0; k < island.shells.size(); k++)
+        {
+            slice.shells[k].insert(slice.shells[k].end(), island.shells[k].begin(), island.shells[k].end());
+        }
     }
 
+    // modifiers: their regions are sliced at the heights of the layers, the walls inside them change before the surfaces are calculated
+    vector<vector<Clipper2Lib::PathsD>> regions;
+    vector<Clipper2Lib::PathsD> modifiedAreas(slices.size());
+    if (modifiers.size() > 0)
+    {
+        vector<Clipper2Lib::PathsD> layers(slices.size());
+        vector<double> heights(slices.size());
+        for (int i = 0; i < slices.size(); i++)
+        {
+            layers[i] = slices[i].paths;
+            heights[i] = slices[i].height;
+        }
+        regions = Modifiers::SliceRegions(modifiers, layers, heights, settings);
 
-    if (settings.GetSkirt().enabled) {
-        for (int i = 0; i < settings.GetSkirt().height; i++)
+        #pragma omp parallel for schedule(dynamic)
+        for (int i = 0; i < slices.size(); i++)
         {
-            Slice skirtSlice = slices[0];
-            for (int j = 0; j < settings.GetSkirt().lines; j++) {
-                Clipper2Lib::PathsD skirtLine = Clipper2Lib::InflatePaths(skirtSlice.outerWall, settings.GetNozzleDiameter() * j + settings.GetSkirt().distance, Clipper2Lib::JoinType::Round, Clipper2Lib::EndType::Polygon);
-                slices[i].skirt.push_back(skirtLine);
+            for (Clipper2Lib::PathsD &region : regions[i])
+            {
+                if (region.size() > 0)
+                {
+                    modifiedAreas[i] = Clipper2Lib::Union(modifiedAreas[i], region, Clipper2Lib::FillRule::NonZero);
+                }
+            }
+            if (modifiedAreas[i].size() > 0)
+            {
+                ApplyModifierShells(slices[i], regions[i], modifiers, settings);
             }
         }
     }
 
+
     // calculate surfaces
-    #pragma omp parallel for
+    // a layer is a roof (floor) where it is not covered by all of the next roofs (previous floors) layers,
+    // the intersections of those windows of layers are shared by neighbouring layers instead of being computed per layer
+    vector<Clipper2Lib::PathsD> innerWalls(slices.size());
     for (int i = 0; i < slices.size(); i++)
     {
-        Slice curSlice = slices[i];
-        if (i < slices.size() - settings.GetRoofs())
+        innerWalls[i] = slices[i].innerWall;
+    }
+
+    int roofs = settings.GetRoofs();
+    int floors = settings.GetFloors();
+    int layerCount = slices.size();
+    vector<Clipper2Lib::PathsD> roofCovers = Surface::IntersectWindows(innerWalls, roofs);
+    vector<Clipper2Lib::PathsD> floorWindows;
+    if (floors != roofs)
+    {
+        floorWindows = Surface::IntersectWindows(innerWalls, floors);
+    }
+    vector<Clipper2Lib::PathsD> &floorCovers = floors == roofs ? roofCovers : floorWindows;
+    // nothing is above the top layers or below the bottom layers
+    Clipper2Lib::PathsD uncovered;
+
+    // a modifier with another amount of roofs and floors needs windows of its own size
+    map<int, vector<Clipper2Lib::PathsD>> modifierCovers;
+    for (const Modifier &modifier : modifiers)
+    {
+        int surfaces = modifier.surfaces;
+        if (surfaces > 0 && surfaces != roofs && surfaces != floors && modifierCovers.count(surfaces) == 0)
         {
-            for (int j = i + 1; j <= i + settings.GetRoofs(); j++)
-            {
-                curSlice.roofAdjacences.push_back(slices[j].innerWall);
-            }
-        } else {
-            curSlice.roofAdjacences.push_back(Clipper2Lib::PathsD());
+            modifierCovers[surfaces] = Surface::IntersectWindows(innerWalls, surfaces);
         }
+    }
 
-        if (i >= settings.GetFloors())
+    // bridges: the parts of a layer that have nothing below them, the first layer rests on the bed
+    vector<Clipper2Lib::PathsD> unsupported(slices.size());
+    vector<Clipper2Lib::PathsD> bridgeAreas(slices.size());
+    if (settings.GetBridges())
+    {
+        #pragma omp parallel for
+        for (int i = 1; i < slices.size(); i++)
         {
-            for (int j = i - settings.GetFloors(); j < i; j++)
-            {
-                curSlice.floorAdjacences.push_back(slices[j].innerWall);
-            }
-        } else {
-            curSlice.floorAdjacences.push_back(Clipper2Lib::PathsD());
+            unsupported[i] = Bridges::FindUnsupported(slices[i].infillBoundary, slices[i - 1].paths, settings.GetNozzleDiameter());
         }
-
-        slices[i] = curSlice;
     }
 
+    vector<Clipper2Lib::PathsD> sparseInfillClips(slices.size());
+    vector<Clipper2Lib::PathsD> surfaceAreas(slices.size());
     #pragma omp parallel for
     for (int i = 0; i < slices.size(); i++)
     {
         Slice curSlice = slices[i];
 
-        Clipper2Lib::PathsD offsettedInnerWall = Clipper2Lib::InflatePaths(curSlice.innerWall, -settings.GetNozzleDiameter(), Clipper2Lib::JoinType::Miter, Clipper2Lib::EndType::Polygon);
+        Clipper2Lib::PathsD offsettedInnerWall = curSlice.infillBoundary;
         
-        curSlice.surfaceWall = Surface::CalculateSurface(offsettedInnerWall, curSlice.floorAdjacences, curSlice.roofAdjacences);
-        Clipper2Lib::PathsD sparseInfillClipArea = Surface::CalculateSurface(curSlice.innerWall, curSlice.floorAdjacences, curSlice.roofAdjacences);
+        // layers with a modifier got their gap fill together with their walls
+        if (settings.GetGapFill() && modifiedAreas[i].size() == 0)
+        {
+            curSlice.gapFill = CreateGapFill(curSlice, offsettedInnerWall, settings);
+        }
 
+        Clipper2Lib::PathsD *roofCover = roofs == 0 ? nullptr : i + roofs < layerCount ? &roofCovers[i + 1] : &uncovered;
+        Clipper2Lib::PathsD *floorCover = floors == 0 ? nullptr : i >= floors ? &floorCovers[i - floors] : &uncovered;
+        curSlice.surfaceWall = Surface::CalculateSurface(offsettedInnerWall, floorCover, roofCover);
+        Clipper2Lib::PathsD sparseInfillClipArea = Surface::CalculateSurface(curSlice.innerWall, floorCover, roofCover);
 
-        //generate infill
-        //Take difference of innerwall sparseInfillClipArea
-        curSlice.infill = infillCreator.GetInfill();
+        // inside a modifier the surfaces are as thick as the modifier asks
+        if (modifiedAreas[i].size() > 0)
+        {
+            vector<Clipper2Lib::PathsD> regionWalls(modifiers.size());
+            vector<Clipper2Lib::PathsD> regionClipAreas(modifiers.size());
+            for (int m = 0; m < modifiers.size(); m++)
+            {
+                if (regions[i][m].size() == 0)
+                {
+                    continue;
+                }
+                int surfaces = modifiers[m].surfaces;
+                vector<Clipper2Lib::PathsD> *covers = surfaces <= 0 ? nullptr : surfaces == roofs ? &roofCovers : surfaces == floors ? &floorCovers : &modifierCovers.at(surfaces);
+                Clipper2Lib::PathsD *regionRoofCover = covers == nullptr ? nullptr : i + surfaces < layerCount ? &(*covers)[i + 1] : &uncovered;
+                Clipper2Lib::PathsD *regionFloorCover = covers == nullptr ? nullptr : i >= surfaces ? &(*covers)[i - surfaces] : &uncovered;
+                regionWalls[m] = Surface::CalculateSurface(offsettedInnerWall, regionFloorCover, regionRoofCover);
+                regionClipAreas[m] = Surface::CalculateSurface(curSlice.innerWall, regionFloorCover, regionRoofCover);
+            }
+            curSlice.surfaceWall = Modifiers::Combine(curSlice.surfaceWall, regionWalls, regions[i]);
+            sparseInfillClipArea = Modifiers::Combine(sparseInfillClipArea, regionClipAreas, regions[i]);
+        }
 
-        //calculate clipping area
-        Clipper2Lib::PathsD sparseInfillClip = Clipper2Lib::Difference(offsettedInnerWall, sparseInfillClipArea, Clipper2Lib::FillRule::EvenOdd);
-        curSlice.infill = infillCreator.ClipInfill(curSlice.infill, sparseInfillClip);
+
+        //calculate clipping area of the sparse infill, the infill itself is generated per group of combined layers
+        sparseInfillClips[i] = Clipper2Lib::Difference(offsettedInnerWall, sparseInfillClipArea, Clipper2Lib::FillRule::EvenOdd);
+
+        //bridges reach onto the supported part of the layer and are taken out of the surface and the sparse infill
+        if (unsupported[i].size() > 0)
+        {
+            Clipper2Lib::PathsD fillArea = ShellLadder::Offset(offsettedInnerWall, -settings.GetNozzleDiameter() / 2);
+            bridgeAreas[i] = Bridges::AnchorBridges(unsupported[i], fillArea, settings.GetNozzleDiameter());
+            sparseInfillClips[i] = Clipper2Lib::Difference(sparseInfillClips[i], bridgeAreas[i], Clipper2Lib::FillRule::NonZero);
+        }
 
 
         //calculate surfaceInfill
         Clipper2Lib::PathsD surfaceInfill = infillCreator.GetSurface(i);
-        Clipper2Lib::PathsD inflatedWall = Clipper2Lib::InflatePaths(curSlice.surfaceWall, -settings.GetNozzleDiameter() / 2, Clipper2Lib::JoinType::Miter, Clipper2Lib::EndType::Polygon);
+        Clipper2Lib::PathsD inflatedWall = ShellLadder::Offset(curSlice.surfaceWall, -settings.GetNozzleDiameter() / 2);
+        if (bridgeAreas[i].size() > 0)
+        {
+            inflatedWall = Clipper2Lib::Difference(inflatedWall, bridgeAreas[i], Clipper2Lib::FillRule::NonZero);
+        }
+
         curSlice.surface = infillCreator.ClipInfill(surfaceInfill, inflatedWall);
+        if (settings.GetIroning())
+        {
+            surfaceAreas[i] = inflatedWall;
+        }
+        //monotonic surfaces are ordered line by line, connected lines would run back over lines that are already printed
+        if (settings.GetConnectInfill() && !settings.GetMonotonicSurface())
+        {
+            curSlice.surface = ConnectInfill::Connect(curSlice.surface, inflatedWall, infillCreator.GetSurfaceSpacing() * 3);
+        }
         slices[i] = curSlice;
     }
 
+    // ironing: only the parts of the surfaces that nothing is printed on
+    if (settings.GetIroning())
+    {
+        #pragma omp parallel for
+        for (int i = 0; i < slices.size(); i++)
+        {
+            if (surfaceAreas[i].size() > 0)
+            {
+                slices[i].ironing = CreateIroning(infillCreator, surfaceAreas[i], i + 1 < slices.size() ? &slices[i + 1].paths : nullptr, i, settings);
+            }
+        }
+    }
+
+    // only a few layers have bridges, the layers are handled one by one and the bridge directions are searched in parallel
+    for (int i = 0; i < slices.size(); i++)
+    {
+        if (bridgeAreas[i].size() > 0)
+        {
+            slices[i].bridges = Bridges::CreateBridges(infillCreator, bridgeAreas[i], unsupported[i], settings);
+        }
+    }
+
+    // gradual infill: areas of the sparse infill that are close to a roof get denser infill
+    int gradualSteps = settings.GetGradualInfillSteps();
+    vector<vector<Clipper2Lib::PathsD>> roofDistances(slices.size());
+    if (gradualSteps > 0)
+    {
+        int stepLayers = settings.GetGradualInfillStepLayers();
+        vector<vector<Clipper2Lib::PathsD>> stepCovers(gradualSteps);
+        for (int k = 0; k < gradualSteps; k++)
+        {
+            stepCovers[k] = Surface::IntersectWindows(innerWalls, (k + 1) * stepLayers);
+        }
+
+        #pragma omp parallel for
+        for (int i = 0; i < slices.size(); i++)
+        {
+            vector<Clipper2Lib::PathsD *> covers(gradualSteps);
+            for (int k = 0; k < gradualSteps; k++)
+            {
+                covers[k] = i + (k + 1) * stepLayers < layerCount ? &stepCovers[k][i + 1] : &uncovered;
+            }
+            roofDistances[i] = Surface::CalculateRoofDistances(sparseInfillClips[i], covers);
+        }
+    }
+
+    // inside a modifier the sparse infill has its own density, it is printed on every layer and never combined
+    vector<vector<Clipper2Lib::PathsD>> regionClips(slices.size());
+    vector<CreateInfill> modifierInfill(modifiers.size());
+    if (modifiers.size() > 0)
+    {
+        for (int m = 0; m < modifiers.size(); m++)
+        {
+            if (modifiers[m].infill > 0)
+            {
+                modifierInfill[m].CreatePatternInfill(settings.GetInfillType(), modifiers[m].infill, settings);
+                modifierInfill[m].CreateGradualInfill(gradualSteps, settings);
+            }
+        }
+
+        #pragma omp parallel for
+        for (int i = 0; i < slices.size(); i++)
+        {
+            if (modifiedAreas[i].size() == 0)
+            {
+                continue;
+            }
+            regionClips[i].resize(modifiers.size());
+            for (int m = 0; m < modifiers.size(); m++)
+            {
+                if (regions[i][m].size() > 0)
+                {
+                    regionClips[i][m] = Clipper2Lib::Intersect(sparseInfillClips[i], regions[i][m], Clipper2Lib::FillRule::NonZero);
+                }
+            }
+            sparseInfillClips[i] = Clipper2Lib::Difference(sparseInfillClips[i], modifiedAreas[i], Clipper2Lib::FillRule::NonZero);
+        }
+    }
+
+    // sparse infill: print the area shared by a group of layers once, on the top layer of the group, at the thickness of the group
+    int combineLayers = settings.GetEffectiveCombineInfill();
+    int groups = (slices.size() + combineLayers - 1) / combineLayers;
+    #pragma omp parallel for
+    for (int g = 0; g < groups; g++)
+    {
+        int groupStart = g * combineLayers;
+        int groupEnd = min(groupStart + combineLayers, (int)slices.size()) - 1;
+
+        if (groupStart == groupEnd)
+        {
+            slices[groupStart].infill = CreateSparseInfill(infillCreator, sparseInfillClips[groupStart], roofDistances[groupStart], settings);
+            continue;
+        }
+
+        Clipper2Lib::PathsD combinedArea = sparseInfillClips[groupStart];
+        for (int i = groupStart + 1; i <= groupEnd; i++)
+        {
+            combinedArea = Clipper2Lib::Intersect(combinedArea, sparseInfillClips[i], Clipper2Lib::FillRule::EvenOdd);
+        }
+
+        // the top layer of the group is the closest to a roof, so its density is used for the whole group
+        slices[groupEnd].combinedInfill = CreateSparseInfill(infillCreator, combinedArea, roofDistances[groupEnd], settings);
+        slices[groupEnd].combinedInfillLayers = groupEnd - groupStart + 1;
+
+        // whatever is not shared by the whole group is still printed at normal thickness
+        for (int i = groupStart; i <= groupEnd; i++)
+        {
+            Clipper2Lib::PathsD remainingArea = Clipper2Lib::Difference(sparseInfillClips[i], combinedArea, Clipper2Lib::FillRule::EvenOdd);
+            slices[i].infill = CreateSparseInfill(infillCreator, remainingArea, roofDistances[i], settings);
+        }
+    }
+
+    #pragma omp parallel for
+    for (int i = 0; i < slices.size(); i++)
+    {
+        for (int m = 0; m < regionClips[i].size(); m++)
+        {
+            if (regionClips[i][m].size() > 0 && modifiers[m].infill > 0)
+            {
+                Clipper2Lib::PathsD regionInfill = CreateSparseInfill(modifierInfill[m], regionClips[i][m], roofDistances[i], settings);
+                slices[i].infill.insert(slices[i].infill.end(), regionInfill.begin(), regionInfill.end());
+            }
+        }
+    }
+
     return slices;
 }
 
+void Slicing::AddSupports(vector<Slice> &slices, SlicerSettings &settings)
+{
+    // supports: the areas are carried down from the top, the lines of every layer are independent
+    if (settings.GetSupports())
+    {
+        CreateInfill infillCreator;
+        vector<Clipper2Lib::PathsD> layers(slices.size());
+        for (int i = 0; i < slices.size(); i++)
+        {
+            layers[i] = slices[i].paths;
+        }
+        bool trees = settings.GetSupportType() == SupportType::Tree;
+        vector<Clipper2Lib::PathsD> supportAreas = trees ? TreeSupport::CalculateTreeAreas(layers, settings) : Support::CalculateSupportAreas(layers, settings);
+        vector<Clipper2Lib::PathsD> interfaces = Support::CalculateInterfaces(supportAreas, settings.GetSupportInterfaceLayers());
+
+        double supportSpacing = settings.GetNozzleDiameter() * 100 / settings.GetSupportDensity();
+        #pragma omp parallel for
+        for (int i = 0; i < slices.size(); i++)
+        {
+            if (supportAreas[i].size() == 0)
+            {
+                continue;
+            }
+            Clipper2Lib::PathsD area = supportAreas[i];
+            Clipper2Lib::PathsD interface = interfaces[i];
+            if (trees)
+            {
+                // branches are thin, they get an outline and only the thick trunks get lines inside it
+                slices[i].support = Support::CreateSupportWalls(area, settings.GetNozzleDiameter());
+                area = ShellLadder::Offset(area, -settings.GetNozzleDiameter());
+                interface = Clipper2Lib::Intersect(interface, area, Clipper2Lib::FillRule::NonZero);
+            }
+            Clipper2Lib::PathsD body = Clipper2Lib::Difference(area, interface, Clipper2Lib::FillRule::NonZero);
+            Clipper2Lib::PathsD lines = Support::CreateSupportLines(infillCreator, body, supportSpacing, 0, settings.GetConnectInfill(), settings.GetNozzleDiameter());
+            slices[i].support.insert(slices[i].support.end(), lines.begin(), lines.end());
+            // the interface lines cross the ones of the layer below
+            double interfaceAngle = i % 2 == 0 ? 0 : M_PI / 2;
+            slices[i].supportInterface = Support::CreateSupportLines(infillCreator, interface, settings.GetNozzleDiameter(), interfaceAngle, settings.GetConnectInfill(), settings.GetNozzleDiameter());
+        }
+    }
+
+}
+
+void Slicing::AddAdhesion(vector<Slice> &slices, SlicerSettings &settings)
+{
+    // adhesion: the raft goes below the first layer, skirt and brim go around whatever is printed on the bed
+    if (slices.size() == 0)
+    {
+        return;
+    }
+    float layerHeight = settings.GetLayerHeight();
+    Clipper2Lib::PathsD firstLayer = slices[0].outerWall;
+    if (settings.GetRaft().enabled)
+    {
+        CreateInfill infillCreator;
+        Clipper2Lib::PathsD raftArea = Adhesion::CreateRaftArea(firstLayer, settings);
+        vector<Clipper2Lib::PathsD> raftLayers = Adhesion::CreateRaftLayers(infillCreator, raftArea, settings);
+        vector<Slice> raftSlices(raftLayers.size());
+        for (int k = 0; k < raftLayers.size(); k++)
+        {
+            raftSlices[k].height = layerHeight * (k + 0.5);
+            raftSlices[k].raft = raftLayers[k];
+        }
+
+        // the model moves up by the height of the raft
+        for (Slice &slice : slices)
+        {
+            slice.height += layerHeight * raftLayers.size();
+        }
+        slices.insert(slices.begin(), raftSlices.begin(), raftSlices.end());
+        firstLayer = raftArea;
+    }
+    else if (settings.GetBrim().enabled)
+    {
+        slices[0].skirt = Adhesion::CreateBrim(firstLayer, settings);
+        if (slices[0].skirt.size() > 0)
+        {
+            firstLayer = slices[0].skirt.back();
+        }
+    }
+
+    // the skirt is computed once and repeated on the first layers
+    if (settings.GetSkirt().enabled)
+    {
+        vector<Clipper2Lib::PathsD> skirt = Adhesion::CreateSkirt(firstLayer, settings);
+        for (int i = 0; i < settings.GetSkirt().height && i < slices.size(); i++)
+        {
+            slices[i].skirt.insert(slices[i].skirt.begin(), skirt.begin(), skirt.end());
+        }
+    }
+}
+
+Slice Slicing::CreateWalls(Clipper2Lib::PathsD &island, SlicerSettings &settings)
+{
+    Slice slice;
+    Clipper2Lib::PathsD paths = island;
+    if (settings.GetVariableWidthWalls())
+    {
+        //the outer wall only goes where a full line fits on both sides: erode by the nozzle diameter and grow back by half of it
+        paths = ShellLadder::Offset(paths, -settings.GetNozzleDiameter(), Clipper2Lib::JoinType::Miter, 3);
+        paths = ShellLadder::Offset(paths, settings.GetNozzleDiameter() / 2, Clipper2Lib::JoinType::Miter, 3);
+        paths = Decimation::Decimate(paths, settings.GetMaxDeviation(), settings.GetMinSegmentLength());
+
+        //whatever the outer wall does not cover is printed along its centre line
+        Clipper2Lib::PathsD wallArea = ShellLadder::Offset(paths, settings.GetNozzleDiameter() / 2, Clipper2Lib::JoinType::Miter, 3);
+        Clipper2Lib::PathsD thinArea = Clipper2Lib::Difference(island, wallArea, Clipper2Lib::FillRule::NonZero);
+        slice.thinWalls = VariableWidthWalls::CreateCenterLines(thinArea, settings.GetNozzleDiameter() / 2, settings.GetNozzleDiameter() * 2, settings.GetNozzleDiameter() / 16);
+    }
+    else
+    {
+        //erode outerWall by half the nozzle diameter
+        paths = ShellLadder::Offset(paths, -settings.GetNozzleDiameter() / 2, Clipper2Lib::JoinType::Miter, 3);
+        paths = Decimation::Decimate(paths, settings.GetMaxDeviation(), settings.GetMinSegmentLength());
+    }
+    slice.outerWall = paths;
+
+    //inner shells and the boundary of the infill are all offsets of the outer wall, computed in one pass
+    vector<double> deltas;
+    for (int k = 1; k <= settings.GetShells(); k++)
+    {
+        deltas.push_back(-settings.GetNozzleDiameter() * k);
+    }
+    //without inner shells the infill still starts one line inside the outer wall
+    if (deltas.size() == 0)
+    {
+        deltas.push_back(-settings.GetNozzleDiameter());
+    }
+    vector<Clipper2Lib::PathsD> ladder = ShellLadder::Offset(paths, deltas);
+
+    //add inner shells, offsets of a decimated wall get new short segments in the corners so they are decimated as well
+    for (int k = 0; k + 1 < ladder.size(); k++)
+    {
+        slice.shells.push_back(Decimation::Decimate(ladder[k], settings.GetMaxDeviation(), settings.GetMinSegmentLength()));
+    }
+
+    //set inner wall
+    slice.innerWall = slice.shells.size() > 0 ? slice.shells.back() : paths;
+    slice.infillBoundary = Decimation::Decimate(ladder.back(), settings.GetMaxDeviation(), settings.GetMinSegmentLength());
+
+    return slice;
+}
+
+void Slicing::ApplyModifierShells(Slice &slice, vector<Clipper2Lib::PathsD> &regions, const vector<Modifier> &modifiers, SlicerSettings &settings)
+{
+    // every region has its own amount of shells, the area outside all regions keeps the regular amount
+    int shells = settings.GetShells();
+    int maxShells = shells;
+    for (int m = 0; m < modifiers.size(); m++)
+    {
+        if (regions[m].size() > 0)
+        {
+            maxShells = max(maxShells, modifiers[m].shells);
+        }
+    }
+    Clipper2Lib::PathsD outside = slice.paths;
+    for (Clipper2Lib::PathsD &region : regions)
+    {
+        if (region.size() > 0)
+        {
+            outside = Clipper2Lib::Difference(outside, region, Clipper2Lib::FillRule::EvenOdd);
+        }
+    }
+
+    // the gaps between the regular walls are only filled outside the regions, the walls inside them are about to change
+    if (settings.GetGapFill())
+    {
+        slice.gapFill = CreateGapFill(slice, slice.infillBoundary, settings, &outside);
+    }
+
+    //the walls of every region are offsets of the outer wall, just like the regular walls
+    double width = settings.GetNozzleDiameter();
+    vector<double> deltas;
+    for (int k = 1; k <= maxShells; k++)
+    {
+        deltas.push_back(-width * k);
+    }
+    if (deltas.size() == 0)
+    {
+        deltas.push_back(-width);
+    }
+    vector<Clipper2Lib::PathsD> ladder = ShellLadder::Offset(slice.outerWall, deltas);
+    for (Clipper2Lib::PathsD &offset : ladder)
+    {
+        offset = Decimation::Decimate(offset, settings.GetMaxDeviation(), settings.GetMinSegmentLength());
+    }
+
+    //shell k lies between the walls of every region with more than k + 1 shells, a shell that is not everywhere is cut open at the borders
+    for (int k = 0; k + 1 < maxShells; k++)
+    {
+        bool everywhere = shells >= k + 2;
+        Clipper2Lib::PathsD area = everywhere ? outside : Clipper2Lib::PathsD();
+        for (int m = 0; m < modifiers.size(); m++)
+        {
+            if (regions[m].size() == 0)
+            {
+                continue;
+            }
+            if (modifiers[m].shells >= k + 2)
+            {
+                area = Clipper2Lib::Union(area, regions[m], Clipper2Lib::FillRule::NonZero);
+            }
+            else
+            {
+                everywhere = false;
+            }
+        }
+        if (everywhere || area.size() == 0)
+        {
+            if (!everywhere && k < slice.shells.size())
+            {
+                slice.shells[k].clear();
+            }
+            continue;
+        }
+
+        // the loops are closed by repeating their first point and clipped as open lines
+        Clipper2Lib::PathsD loops = k < slice.shells.size() ? slice.shells[k] : ladder[k];
+        if (k < slice.shells.size())
+        {
+            slice.shells[k].clear();
+        }
+        for (Clipper2Lib::PathD &loop : loops)
+        {
+            loop.push_back(loop[0]);
+        }
+        Clipper2Lib::ClipperD clipper;
+        Clipper2Lib::PathsD closedPaths;
+        Clipper2Lib::PathsD openPaths;
+        clipper.AddOpenSubject(loops);
+        clipper.AddClip(area);
+        clipper.Execute(Clipper2Lib::ClipType::Intersection, Clipper2Lib::FillRule::NonZero, closedPaths, openPaths);
+        for (Clipper2Lib::PathD &path : openPaths)
+        {
+            slice.partialShells.push_back({path, vector<double>(path.size(), width)});
+        }
+    }
+
+    //the inner wall and the infill boundary of every region follow its own amount of shells
+    vector<Clipper2Lib::PathsD> innerWalls(modifiers.size());
+    vector<Clipper2Lib::PathsD> infillBoundaries(modifiers.size());
+    for (int m = 0; m < modifiers.size(); m++)
+    {
+        if (regions[m].size() == 0)
+        {
+            continue;
+        }
+        int count = max(0, modifiers[m].shells);
+        innerWalls[m] = count >= 2 ? ladder[count - 2] : slice.outerWall;
+        //without shells the infill still starts one line inside the outer wall, ladder[0] is that offset
+        infillBoundaries[m] = ladder[max(0, count - 1)];
+    }
+    slice.innerWall = Modifiers::Combine(slice.innerWall, innerWalls, regions);
+    slice.infillBoundary = Modifiers::Combine(slice.infillBoundary, infillBoundaries, regions);
+}
+
+Clipper2Lib::PathsD Slicing::CreateIroning(CreateInfill &infillCreator, Clipper2Lib::PathsD &surfaceArea, Clipper2Lib::PathsD *layerAbove, int layer, SlicerSettings &settings)
+{
+    // the top surface is the part of the surface that is not covered by the next layer, the top layer is a top surface everywhere
+    Clipper2Lib::PathsD topArea = surfaceArea;
+    if (layerAbove != nullptr)
+    {
+        topArea = Clipper2Lib::Difference(surfaceArea, *layerAbove, Clipper2Lib::FillRule::NonZero);
+    }
+    // the edges of the top surface are left alone so the nozzle does not drag over the walls
+    topArea = ShellLadder::Offset(topArea, -settings.GetNozzleDiameter() / 2);
+    if (topArea.size() == 0)
+    {
+        return Clipper2Lib::PathsD();
+    }
+
+    // lines are only created over the top surface itself, across the direction of the surface lines below
+    double spacing = settings.GetNozzleDiameter() / 4;
+    double angle = layer % 2 == 0 ? M_PI * 3 / 4 : M_PI / 4;
+    Clipper2Lib::PathsD lines = CreateInfill::CreateScanlines(Clipper2Lib::GetBounds(topArea), spacing, angle);
+    Clipper2Lib::PathsD ironing = infillCreator.ClipInfill(lines, topArea);
+
+    // ironing is always connected, the nozzle should stay down on the surface
+    return ConnectInfill::Connect(ironing, topArea, spacing * 3);
+}
+
+vector<VariableWidthPath> Slicing::CreateGapFill(Slice &slice, Clipper2Lib::PathsD &offsettedInnerWall, SlicerSettings &settings, Clipper2Lib::PathsD *area)
+{
+    // walls from the outside in, the infill and surfaces start at the offsetted inner wall
+    vector<Clipper2Lib::PathsD> walls;
+    walls.push_back(slice.outerWall);
+    walls.insert(walls.end(), slice.shells.begin(), slice.shells.end());
+    walls.push_back(offsettedInnerWall);
+
+    // a gap is the part inside a wall that is not covered by the next wall
+    // the inside of every wall lies half a line further from the outer wall than the wall itself
+    double width = settings.GetNozzleDiameter();
+    vector<double> insideDeltas;
+    for (int i = 0; i + 1 < walls.size(); i++)
+    {
+        insideDeltas.push_back(-width * (i + 0.5));
+    }
+    vector<Clipper2Lib::PathsD> insides = ShellLadder::Offset(slice.outerWall, insideDeltas, Clipper2Lib::JoinType::Miter, 3);
+
+    Clipper2Lib::PathsD gaps;
+    for (int i = 0; i + 1 < walls.size(); i++)
+    {
+        if (walls[i].size() == 0)
+        {
+            break;
+        }
+        Clipper2Lib::PathsD covered = ShellLadder::Offset(walls[i + 1], width / 2, Clipper2Lib::JoinType::Miter, 3);
+        gaps = Clipper2Lib::Union(gaps, Clipper2Lib::Difference(insides[i], covered, Clipper2Lib::FillRule::NonZero), Clipper2Lib::FillRule::NonZero);
+    }
+    if (area != nullptr)
+    {
+        gaps = Clipper2Lib::Intersect(gaps, *area, Clipper2Lib::FillRule::NonZero);
+    }
+
+    return VariableWidthWalls::CreateCenterLines(gaps, width / 2, width * 2, width / 16);
+}
+
+Clipper2Lib::PathsD Slicing::CreateSparseInfill(CreateInfill &infillCreator, Clipper2Lib::PathsD &clipArea, vector<Clipper2Lib::PathsD> &roofDistances, SlicerSettings &settings)
+{
+    Clipper2Lib::PathsD infill;
+    if (clipArea.size() == 0)
+    {
+        return infill;
+    }
+
+    // split the area in bands by distance to the nearest roof, the closest band gets the densest pattern
+    vector<Clipper2Lib::PathsD> bands;
+    Clipper2Lib::PathsD remainingArea = clipArea;
+    for (int k = 0; k < roofDistances.size() && remainingArea.size() > 0; k++)
+    {
+        bands.push_back(Clipper2Lib::Intersect(remainingArea, roofDistances[k], Clipper2Lib::FillRule::EvenOdd));
+        remainingArea = Clipper2Lib::Difference(remainingArea, roofDistances[k], Clipper2Lib::FillRule::EvenOdd);
+    }
+    bands.resize(roofDistances.size());
+    bands.push_back(remainingArea);
+
+    for (int k = 0; k < bands.size(); k++)
+    {
+        if (bands[k].size() == 0)
+        {
+            continue;
+        }
+
+        // the pattern is only generated over the bounds of every island instead of over the whole layer
+        int level = bands.size() - 1 - k;
+        for (Clipper2Lib::PathsD &island : Islands::Split(bands[k], Clipper2Lib::FillRule::EvenOdd))
+        {
+            Clipper2Lib::PathsD islandInfill = infillCreator.GetInfill(Clipper2Lib::GetBounds(island), level);
+            islandInfill = infillCreator.ClipInfill(islandInfill, island);
+            if (settings.GetConnectInfill())
+            {
+                islandInfill = ConnectInfill::Connect(islandInfill, island, infillCreator.GetInfillSpacing(level) * 3);
+            }
+            infill.insert(infill.end(), islandInfill.begin(), islandInfill.end());
+        }
+    }
+    return infill;
+}
+
 #endif
\ No newline at end of file
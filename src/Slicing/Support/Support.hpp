@@ -0,0 +1,155 @@
+#ifndef SUPPORT_HPP
+#define SUPPORT_HPP
+
+#include <vector>
+#include <cmath>
+#include "clipper2/clipper.h"
+#include "../../SlicerSettings/SlicerSettings.hpp"
+#include "../Infill/CreateInfill.hpp"
+#include "../Infill/ConnectInfill.hpp"
+#include "../Walls/ShellLadder.hpp"
+#include "../Islands/Islands.hpp"
+#include "../Surface/Surface.hpp"
+
+// support below overhangs: every layer keeps the support of the layer above and adds the overhangs that need it,
+// minus the model itself and a gap around it so the support does not stick to the walls
+class Support
+{
+public:
+    static const int topGapLayers = 1; //empty layers between the top of the support and the overhang it carries
+    static double GetSupportGap(double nozzleDiameter) { return nozzleDiameter * 1.5; } //the support stays a line and a half away from the model
+
+    static Clipper2Lib::PathsD FindOverhang(Clipper2Lib::PathsD &layer, Clipper2Lib::PathsD &layerBelow, double allowedOverhang, double nozzleDiameter);
+    static vector<Clipper2Lib::PathsD> CalculateSupportAreas(vector<Clipper2Lib::PathsD> &layers, SlicerSettings &settings);
+    static vector<Clipper2Lib::PathsD> CalculateInterfaces(vector<Clipper2Lib::PathsD> &supportAreas, int interfaceLayers);
+    static Clipper2Lib::PathsD CreateSupportLines(CreateInfill &infillCreator, Clipper2Lib::PathsD &area, double spacing, double angle, bool connect, double nozzleDiameter);
+    static Clipper2Lib::PathsD CreateSupportWalls(Clipper2Lib::PathsD &area, double nozzleDiameter);
+};
+
+vector<Clipper2Lib::PathsD> Support::CalculateSupportAreas(vector<Clipper2Lib::PathsD> &layers, SlicerSettings &settings)
+{
+    int n = layers.size();
+    double nozzleDiameter = settings.GetNozzleDiameter();
+    // a layer may stick out this far over the layer below before it needs support
+    double allowedOverhang = settings.GetLayerHeight() * tan(settings.GetSupportAngle() * M_PI / 180);
+    double supportGap = GetSupportGap(nozzleDiameter);
+
+    // overhangs and the space the model takes up only depend on their own layer, they are computed ahead in parallel
+    vector<Clipper2Lib::PathsD> overhangs(n);
+    vector<Clipper2Lib::PathsD> blocked(n);
+    #pragma omp parallel for
+    for (int i = 0; i < n; i++)
+    {
+        if (i > 0)
+        {
+            overhangs[i] = FindOverhang(layers[i], layers[i - 1], allowedOverhang, nozzleDiameter);
+        }
+        blocked[i] = ShellLadder::Offset(layers[i], supportGap, Clipper2Lib::JoinType::Round);
+    }
+
+    // top down: a layer supports whatever the layer above supports, the separate support islands are clipped in parallel
+    vector<Clipper2Lib::PathsD> areas(n);
+    Clipper2Lib::PathsD carried;
+    for (int i = n - 1; i >= 0; i--)
+    {
+        Clipper2Lib::PathsD needed = carried;
+        int overhangLayer = i + 1 + topGapLayers;
+        if (overhangLayer < n)
+        {
+            needed.insert(needed.end(), overhangs[overhangLayer].begin(), overhangs[overhangLayer].end());
+        }
+        if (needed.size() == 0)
+        {
+            carried.clear();
+            continue;
+        }
+
+        vector<Clipper2Lib::PathsD> islands = Islands::Split(needed);
+        vector<Clipper2Lib::PathsD> parts(islands.size());
+        #pragma omp parallel for schedule(dynamic)
+        for (int k = 0; k < islands.size(); k++)
+        {
+            // support that runs into the model rests on it and stops there
+            parts[k] = Clipper2Lib::Difference(islands[k], blocked[i], Clipper2Lib::FillRule::NonZero);
+        }
+        for (Clipper2Lib::PathsD &part : parts)
+        {
+            areas[i].insert(areas[i].end(), part.begin(), part.end());
+        }
+        carried = areas[i];
+    }
+
+    return areas;
+}
+
+Clipper2Lib::PathsD Support::FindOverhang(Clipper2Lib::PathsD &layer, Clipper2Lib::PathsD &layerBelow, double allowedOverhang, double nozzleDiameter)
+{
+    Clipper2Lib::PathsD supported = ShellLadder::Offset(layerBelow, allowedOverhang);
+    Clipper2Lib::PathsD overhang = Clipper2Lib::Difference(layer, supported, Clipper2Lib::FillRule::EvenOdd);
+
+    // slivers along slopes that are just over the angle are too narrow to hold a support line
+    overhang = ShellLadder::Offset(overhang, -nozzleDiameter / 2);
+    overhang = ShellLadder::Offset(overhang, nozzleDiameter / 2);
+    return overhang;
+}
+
+vector<Clipper2Lib::PathsD> Support::CalculateInterfaces(vector<Clipper2Lib::PathsD> &supportAreas, int interfaceLayers)
+{
+    // the interface is the part of the support with an overhang within interfaceLayers above it, like the roofs of the model
+    int n = supportAreas.size();
+    vector<Clipper2Lib::PathsD> interfaces(n);
+    if (interfaceLayers <= 0)
+    {
+        return interfaces;
+    }
+
+    vector<Clipper2Lib::PathsD> covers = Surface::IntersectWindows(supportAreas, interfaceLayers);
+    #pragma omp parallel for
+    for (int i = 0; i < n; i++)
+    {
+        if (supportAreas[i].size() == 0)
+        {
+            continue;
+        }
+        if (i + interfaceLayers < n)
+        {
+            interfaces[i] = Clipper2Lib::Difference(supportAreas[i], covers[i + 1], Clipper2Lib::FillRule::NonZero);
+        }
+        else
+        {
+            interfaces[i] = supportAreas[i];
+        }
+    }
+    return interfaces;
+}
+
+Clipper2Lib::PathsD Support::CreateSupportLines(CreateInfill &infillCreator, Clipper2Lib::PathsD &area, double spacing, double angle, bool connect, double nozzleDiameter)
+{
+    // the lines stay half a line inside the support area
+    Clipper2Lib::PathsD clipArea = ShellLadder::Offset(area, -nozzleDiameter / 2);
+    if (clipArea.size() == 0)
+    {
+        return Clipper2Lib::PathsD();
+    }
+
+    Clipper2Lib::PathsD lines = CreateInfill::CreateScanlines(Clipper2Lib::GetBounds(clipArea), spacing, angle);
+    lines = infillCreator.ClipInfill(lines, clipArea);
+    if (connect)
+    {
+        lines = ConnectInfill::Connect(lines, clipArea, spacing * 3);
+    }
+    return lines;
+}
+
+Clipper2Lib::PathsD Support::CreateSupportWalls(Clipper2Lib::PathsD &area, double nozzleDiameter)
+{
+    // closed outlines half a line inside the area, the first point is repeated because support is written as open lines
+    Clipper2Lib::PathsD walls = ShellLadder::Offset(area, -nozzleDiameter / 2);
+    for (Clipper2Lib::PathD &wall : walls)
+    {
+        wall.push_back(wall.front());
+    }
+    return walls;
+}
+
+#endif
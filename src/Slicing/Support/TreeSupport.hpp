@@ -0,0 +1,371 @@
+#ifndef TREESUPPORT_HPP
+#define TREESUPPORT_HPP
+
+#include <vector>
+#include <cmath>
+#include <unordered_map>
+#include "clipper2/clipper.h"
+#include "../../SlicerSettings/SlicerSettings.hpp"
+#include "../Walls/ShellLadder.hpp"
+#include "Support.hpp"
+
+// support as branches: every overhang gets contact points, the branches grow down from there and move around the model,
+// branches close to each other lean towards each other and merge into a thicker branch
+// only the current layer is kept while routing, so memory does not grow with the height of the print
+class TreeSupport
+{
+private:
+    struct Node
+    {
+        Clipper2Lib::PointD position;
+        double radius;
+        int avoiding = 0; //layers in a row the branch has been too close to the model
+    };
+
+    static const int circleSegments = 16;
+    static const int maxAvoidLayers = 10; //a branch that is still too close to the model after this many layers goes straight down
+
+    static vector<Node> SampleContacts(Clipper2Lib::PathsD &overhang, double spacing, double radius);
+    static vector<vector<int>> GroupNodes(vector<Node> &nodes, double range);
+    static void MoveGroup(vector<Node> &nodes, vector<int> &group, vector<char> &removed, vector<Clipper2Lib::PathsD> &collision, vector<double> &collisionRadii,
+                          Clipper2Lib::PathsD &layer, double maxMove, double mergeRange, double maxRadius);
+    static Clipper2Lib::PointD NearestOutside(Clipper2Lib::PointD point, Clipper2Lib::PathsD &area);
+    static bool IsInside(Clipper2Lib::PointD point, Clipper2Lib::PathsD &area);
+    static Clipper2Lib::PathD Circle(Clipper2Lib::PointD center, double radius);
+    static double Distance(Clipper2Lib::PointD a, Clipper2Lib::PointD b) { return sqrt(pow(a.x - b.x, 2) + pow(a.y - b.y, 2)); }
+
+    static int FindRoot(vector<int> &parents, int i);
+    static int64_t CellKey(int x, int y) { return (int64_t)(((uint64_t)(uint32_t)x << 32) ^ (uint32_t)y); }
+
+public:
+    static vector<Clipper2Lib::PathsD> CalculateTreeAreas(vector<Clipper2Lib::PathsD> &layers, SlicerSettings &settings);
+};
+
+vector<Clipper2Lib::PathsD> TreeSupport::CalculateTreeAreas(vector<Clipper2Lib::PathsD> &layers, SlicerSettings &settings)
+{
+    int n = layers.size();
+    double nozzleDiameter = settings.GetNozzleDiameter();
+    double maxMove = settings.GetLayerHeight() * tan(settings.GetSupportAngle() * M_PI / 180);
+    double supportGap = Support::GetSupportGap(nozzleDiameter);
+    double tipRadius = nozzleDiameter;
+    double maxRadius = nozzleDiameter * 10;
+    double contactSpacing = nozzleDiameter * 5;
+    double mergeRange = nozzleDiameter * 25;
+    // branches get a little thicker on every layer down, so a long branch does not snap
+    double radiusGrowth = settings.GetLayerHeight() * 0.1;
+
+    // the model is inflated for a few branch radii at once, a branch checks the smallest radius that fits it
+    vector<double> collisionRadii;
+    for (double radius = tipRadius; radius < maxRadius; radius *= 2)
+    {
+        collisionRadii.push_back(radius);
+    }
+    collisionRadii.push_back(maxRadius);
+    vector<double> deltas = {supportGap};
+    for (double radius : collisionRadii)
+    {
+        deltas.push_back(supportGap + radius);
+    }
+
+    vector<Clipper2Lib::PathsD> areas(n);
+    vector<Node> nodes;
+    for (int i = n - 1; i >= 0; i--)
+    {
+        // new branches start below the overhangs one gap above this layer
+        int overhangLayer = i + 1 + Support::topGapLayers;
+        if (overhangLayer < n)
+        {
+            Clipper2Lib::PathsD overhang = Support::FindOverhang(layers[overhangLayer], layers[overhangLayer - 1], maxMove, nozzleDiameter);
+            vector<Node> contacts = SampleContacts(overhang, contactSpacing, tipRadius);
+            nodes.insert(nodes.end(), contacts.begin(), contacts.end());
+        }
+        if (nodes.size() == 0)
+        {
+            continue;
+        }
+
+        // the collision field of this layer, the first entry is the area the support has to stay out of
+        vector<Clipper2Lib::PathsD> field = ShellLadder::Offset(layers[i], deltas, Clipper2Lib::JoinType::Round);
+        vector<Clipper2Lib::PathsD> collision(field.begin() + 1, field.end());
+
+        // branches that can not reach each other do not influence each other, those groups are routed in parallel
+        vector<vector<int>> groups = GroupNodes(nodes, mergeRange);
+        // one byte per node, neighbouring bits of a vector<bool> can be written by different groups at once
+        vector<char> removed(nodes.size(), false);
+        #pragma omp parallel for schedule(dynamic)
+        for (int g = 0; g < groups.size(); g++)
+        {
+            MoveGroup(nodes, groups[g], removed, collision, collisionRadii, layers[i], maxMove, mergeRange, maxRadius);
+        }
+
+        vector<Node> remaining;
+        Clipper2Lib::PathsD circles;
+        for (int k = 0; k < nodes.size(); k++)
+        {
+            if (removed[k])
+            {
+                continue;
+            }
+            circles.push_back(Circle(nodes[k].position, nodes[k].radius));
+            nodes[k].radius = min(maxRadius, nodes[k].radius + radiusGrowth);
+            remaining.push_back(nodes[k]);
+        }
+        nodes = remaining;
+
+        Clipper2Lib::PathsD area = Clipper2Lib::Union(circles, Clipper2Lib::FillRule::NonZero);
+        areas[i] = Clipper2Lib::Difference(area, field[0], Clipper2Lib::FillRule::NonZero);
+    }
+
+    return areas;
+}
+
+vector<TreeSupport::Node> TreeSupport::SampleContacts(Clipper2Lib::PathsD &overhang, double spacing, double radius)
+{
+    vector<Node> contacts;
+    for (Clipper2Lib::PathsD &island : Islands::Split(overhang))
+    {
+        // a grid of points over the overhang, small overhangs still get one point
+        Clipper2Lib::RectD bounds = Clipper2Lib::GetBounds(island);
+        int before = contacts.size();
+        for (double y = ceil(bounds.top / spacing) * spacing; y <= bounds.bottom; y += spacing)
+        {
+            for (double x = ceil(bounds.left / spacing) * spacing; x <= bounds.right; x += spacing)
+            {
+                Clipper2Lib::PointD point(x, y);
+                if (IsInside(point, island))
+                {
+                    contacts.push_back({point, radius});
+                }
+            }
+        }
+        if (contacts.size() == before)
+        {
+            Clipper2Lib::PointD center((bounds.left + bounds.right) / 2, (bounds.top + bounds.bottom) / 2);
+            contacts.push_back({IsInside(center, island) ? center : island[0][0], radius});
+        }
+    }
+    return contacts;
+}
+
+vector<vector<int>> TreeSupport::GroupNodes(vector<Node> &nodes, double range)
+{
+    // nodes within range of each other end up in the same group, neighbours are found in a grid of range sized cells
+    vector<int> parents(nodes.size());
+    unordered_map<int64_t, vector<int>> grid;
+    for (int k = 0; k < nodes.size(); k++)
+    {
+        parents[k] = k;
+        int x = (int)floor(nodes[k].position.x / range);
+        int y = (int)floor(nodes[k].position.y / range);
+        grid[CellKey(x, y)].push_back(k);
+    }
+
+    for (int k = 0; k < nodes.size(); k++)
+    {
+        int x = (int)floor(nodes[k].position.x / range);
+        int y = (int)floor(nodes[k].position.y / range);
+        for (int dx = -1; dx <= 1; dx++)
+        {
+            for (int dy = -1; dy <= 1; dy++)
+            {
+                auto cell = grid.find(CellKey(x + dx, y + dy));
+                if (cell == grid.end())
+                {
+                    continue;
+                }
+                for (int other : cell->second)
+                {
+                    if (other != k && Distance(nodes[k].position, nodes[other].position) <= range)
+                    {
+                        parents[FindRoot(parents, k)] = FindRoot(parents, other);
+                    }
+                }
+            }
+        }
+    }
+
+    unordered_map<int, int> groupIndex;
+    vector<vector<int>> groups;
+    for (int k = 0; k < nodes.size(); k++)
+    {
+        int root = FindRoot(parents, k);
+        if (groupIndex.find(root) == groupIndex.end())
+        {
+            groupIndex[root] = groups.size();
+            groups.push_back(vector<int>());
+        }
+        groups[groupIndex[root]].push_back(k);
+    }
+    return groups;
+}
+
+int TreeSupport::FindRoot(vector<int> &parents, int i)
+{
+    while (parents[i] != i)
+    {
+        parents[i] = parents[parents[i]];
+        i = parents[i];
+    }
+    return i;
+}
+
+void TreeSupport::MoveGroup(vector<Node> &nodes, vector<int> &group, vector<char> &removed, vector<Clipper2Lib::PathsD> &collision, vector<double> &collisionRadii,
+                            Clipper2Lib::PathsD &layer, double maxMove, double mergeRange, double maxRadius)
+{
+    // every branch leans towards its nearest neighbour, branches that can reach each other on this layer merge
+    vector<Clipper2Lib::PointD> moved(group.size());
+    for (int a = 0; a < group.size(); a++)
+    {
+        Node &node = nodes[group[a]];
+        moved[a] = node.position;
+        if (removed[group[a]])
+        {
+            continue;
+        }
+
+        int nearest = -1;
+        double nearestDistance = mergeRange;
+        for (int b = 0; b < group.size(); b++)
+        {
+            double distance = Distance(node.position, nodes[group[b]].position);
+            if (b != a && !removed[group[b]] && distance <= nearestDistance)
+            {
+                nearestDistance = distance;
+                nearest = b;
+            }
+        }
+        if (nearest == -1)
+        {
+            continue;
+        }
+
+        Node &other = nodes[group[nearest]];
+        if (nearestDistance <= maxMove * 2)
+        {
+            // the merged branch carries the area of both
+            double weight = node.radius * node.radius + other.radius * other.radius;
+            moved[a] = Clipper2Lib::PointD((node.position.x * node.radius * node.radius + other.position.x * other.radius * other.radius) / weight,
+                                           (node.position.y * node.radius * node.radius + other.position.y * other.radius * other.radius) / weight);
+            node.radius = min(maxRadius, sqrt(weight));
+            removed[group[nearest]] = true;
+        }
+        else
+        {
+            double step = maxMove / nearestDistance;
+            moved[a] = Clipper2Lib::PointD(node.position.x + (other.position.x - node.position.x) * step,
+                                           node.position.y + (other.position.y - node.position.y) * step);
+        }
+    }
+
+    for (int a = 0; a < group.size(); a++)
+    {
+        if (removed[group[a]])
+        {
+            continue;
+        }
+        Node &node = nodes[group[a]];
+        double budget = max(0.0, maxMove - Distance(node.position, moved[a]));
+        node.position = moved[a];
+
+        // a branch that ends up in the model rests on it
+        if (IsInside(node.position, layer))
+        {
+            removed[group[a]] = true;
+            continue;
+        }
+
+        // a branch too close to the model moves out of the way
+        int radiusClass = 0;
+        while (radiusClass + 1 < collisionRadii.size() && collisionRadii[radiusClass] < node.radius)
+        {
+            radiusClass++;
+        }
+        // together with the move above it stays within the overhang angle, a longer way out is spread over the next layers
+        if (IsInside(node.position, collision[radiusClass]))
+        {
+            Clipper2Lib::PointD outside = NearestOutside(node.position, collision[radiusClass]);
+            double distance = Distance(node.position, outside);
+            if (distance <= budget)
+            {
+                node.position = outside;
+                node.avoiding = 0;
+            }
+            else if (++node.avoiding > maxAvoidLayers)
+            {
+                // dropping it would leave the part above hanging in the air, so it goes straight down until it rests on the model,
+                // the part of it that is too close to the model is cut away from the area
+                continue;
+            }
+            else
+            {
+                double step = budget / distance;
+                node.position = Clipper2Lib::PointD(node.position.x + (outside.x - node.position.x) * step,
+                                                    node.position.y + (outside.y - node.position.y) * step);
+            }
+        }
+        else
+        {
+            node.avoiding = 0;
+        }
+    }
+}
+
+Clipper2Lib::PointD TreeSupport::NearestOutside(Clipper2Lib::PointD point, Clipper2Lib::PathsD &area)
+{
+    Clipper2Lib::PointD nearest = point;
+    double nearestDistance = INFINITY;
+    for (Clipper2Lib::PathD &path : area)
+    {
+        for (int k = 0; k < path.size(); k++)
+        {
+            Clipper2Lib::PointD a = path[k];
+            Clipper2Lib::PointD b = path[(k + 1) % path.size()];
+            double dx = b.x - a.x;
+            double dy = b.y - a.y;
+            double lengthSquared = dx * dx + dy * dy;
+            double t = lengthSquared == 0 ? 0 : max(0.0, min(1.0, ((point.x - a.x) * dx + (point.y - a.y) * dy) / lengthSquared));
+            Clipper2Lib::PointD projected(a.x + t * dx, a.y + t * dy);
+            double distance = Distance(point, projected);
+            if (distance < nearestDistance)
+            {
+                nearestDistance = distance;
+                nearest = projected;
+            }
+        }
+    }
+
+    // step just past the boundary so the point is outside
+    if (nearestDistance > 0 && nearestDistance < INFINITY)
+    {
+        double overshoot = 0.01 / nearestDistance;
+        nearest = Clipper2Lib::PointD(nearest.x + (nearest.x - point.x) * overshoot, nearest.y + (nearest.y - point.y) * overshoot);
+    }
+    return nearest;
+}
+
+bool TreeSupport::IsInside(Clipper2Lib::PointD point, Clipper2Lib::PathsD &area)
+{
+    // holes are contained by their outer contour as well, an odd count means the point is inside
+    int count = 0;
+    for (Clipper2Lib::PathD &path : area)
+    {
+        if (Clipper2Lib::PointInPolygon(point, path) != Clipper2Lib::PointInPolygonResult::IsOutside)
+        {
+            count++;
+        }
+    }
+    return count % 2 == 1;
+}
+
+Clipper2Lib::PathD TreeSupport::Circle(Clipper2Lib::PointD center, double radius)
+{
+    Clipper2Lib::PathD circle;
+    for (int k = 0; k < circleSegments; k++)
+    {
+        double angle = 2 * M_PI * k / circleSegments;
+        circle.push_back(Clipper2Lib::PointD(center.x + radius * cos(angle), center.y + radius * sin(angle)));
+    }
+    return circle;
+}
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef BRIDGES_HPP
+#define BRIDGES_HPP
+
+#include <vector>
+#include <cmath>
+#include "clipper2/clipper.h"
+#include "../../SlicerSettings/SlicerSettings.hpp"
+#include "../Infill/CreateInfill.hpp"
+#include "../Infill/ConnectInfill.hpp"
+#include "../Walls/ShellLadder.hpp"
+#include "../Islands/Islands.hpp"
+
+// floors that are printed in mid air, the lines of a bridge run in one direction from one supported edge to the other
+class Bridges
+{
+private:
+    static const int angleSamples = 36; //every 5 degrees
+
+    static double LongestSpan(CreateInfill &infillCreator, Clipper2Lib::PathsD &unsupported, Clipper2Lib::PathsD &anchors, double spacing, double angle);
+    static bool IsInside(Clipper2Lib::PointD point, Clipper2Lib::PathsD &area);
+
+public:
+    static Clipper2Lib::PathsD FindUnsupported(Clipper2Lib::PathsD &area, Clipper2Lib::PathsD &layerBelow, double nozzleDiameter);
+    static Clipper2Lib::PathsD AnchorBridges(Clipper2Lib::PathsD &unsupported, Clipper2Lib::PathsD &fillArea, double nozzleDiameter);
+    static double FindBridgeAngle(CreateInfill &infillCreator, Clipper2Lib::PathsD &unsupported, Clipper2Lib::PathsD &supported, double spacing);
+    static Clipper2Lib::PathsD CreateBridges(CreateInfill &infillCreator, Clipper2Lib::PathsD &bridgeArea, Clipper2Lib::PathsD &unsupported, SlicerSettings &settings);
+};
+
+Clipper2Lib::PathsD Bridges::FindUnsupported(Clipper2Lib::PathsD &area, Clipper2Lib::PathsD &layerBelow, double nozzleDiameter)
+{
+    Clipper2Lib::PathsD unsupported = Clipper2Lib::Difference(area, layerBelow, Clipper2Lib::FillRule::NonZero);
+
+    // slopes overhang a little on every layer, strips narrower than two lines still rest on the layer below
+    unsupported = ShellLadder::Offset(unsupported, -nozzleDiameter);
+    unsupported = ShellLadder::Offset(unsupported, nozzleDiameter);
+    return unsupported;
+}
+
+Clipper2Lib::PathsD Bridges::AnchorBridges(Clipper2Lib::PathsD &unsupported, Clipper2Lib::PathsD &fillArea, double nozzleDiameter)
+{
+    if (unsupported.size() == 0)
+    {
+        return Clipper2Lib::PathsD();
+    }
+
+    // bridge lines continue onto the supported part of the layer so both ends are held down
+    Clipper2Lib::PathsD anchored = ShellLadder::Offset(unsupported, nozzleDiameter * 3);
+    return Clipper2Lib::Intersect(anchored, fillArea, Clipper2Lib::FillRule::NonZero);
+}
+
+double Bridges::FindBridgeAngle(CreateInfill &infillCreator, Clipper2Lib::PathsD &unsupported, Clipper2Lib::PathsD &supported, double spacing)
+{
+    // lines along the edge of the bridge graze the supported area, the anchors are grown a little so they still land on it
+    Clipper2Lib::PathsD anchors = ShellLadder::Offset(supported, spacing / 2);
+
+    // every angle is independent, they are sampled in parallel and the one with the shortest longest span wins
+    vector<double> spans(angleSamples);
+    #pragma omp parallel for
+    for (int k = 0; k < angleSamples; k++)
+    {
+        spans[k] = LongestSpan(infillCreator, unsupported, anchors, spacing, M_PI * k / angleSamples);
+    }
+
+    int best = 0;
+    for (int k = 1; k < angleSamples; k++)
+    {
+        if (spans[k] < spans[best])
+        {
+            best = k;
+        }
+    }
+    return M_PI * best / angleSamples;
+}
+
+double Bridges::LongestSpan(CreateInfill &infillCreator, Clipper2Lib::PathsD &unsupported, Clipper2Lib::PathsD &anchors, double spacing, double angle)
+{
+    Clipper2Lib::RectD bounds = Clipper2Lib::GetBounds(unsupported);
+    Clipper2Lib::PathsD lines = CreateInfill::CreateScanlines(bounds, spacing, angle);
+    Clipper2Lib::PathsD spans = infillCreator.ClipInfill(lines, unsupported);
+
+    // a line that does not land on supported material at both ends hangs in the air, it counts as longer than any anchored line
+    double penalty = sqrt(bounds.Width() * bounds.Width() + bounds.Height() * bounds.Height());
+    double longest = 0;
+    for (Clipper2Lib::PathD &span : spans)
+    {
+        Clipper2Lib::PointD front = span.front();
+        Clipper2Lib::PointD back = span.back();
+        double length = sqrt(pow(back.x - front.x, 2) + pow(back.y - front.y, 2));
+        if (length == 0)
+        {
+            continue;
+        }
+
+        // look just past both ends of the span
+        double stepX = (back.x - front.x) / length * spacing / 2;
+        double stepY = (back.y - front.y) / length * spacing / 2;
+        bool anchored = IsInside(Clipper2Lib::PointD(front.x - stepX, front.y - stepY), anchors) &&
+                        IsInside(Clipper2Lib::PointD(back.x + stepX, back.y + stepY), anchors);
+        longest = max(longest, anchored ? length : length + penalty);
+    }
+    return longest;
+}
+
+bool Bridges::IsInside(Clipper2Lib::PointD point, Clipper2Lib::PathsD &area)
+{
+    // holes are contained by their outer contour as well, an odd count means the point is inside
+    int count = 0;
+    for (Clipper2Lib::PathD &path : area)
+    {
+        if (Clipper2Lib::PointInPolygon(point, path) != Clipper2Lib::PointInPolygonResult::IsOutside)
+        {
+            count++;
+        }
+    }
+    return count % 2 == 1;
+}
+
+Clipper2Lib::PathsD Bridges::CreateBridges(CreateInfill &infillCreator, Clipper2Lib::PathsD &bridgeArea, Clipper2Lib::PathsD &unsupported, SlicerSettings &settings)
+{
+    Clipper2Lib::PathsD bridges;
+    double spacing = settings.GetNozzleDiameter();
+
+    // separate bridges can span in different directions
+    vector<Clipper2Lib::PathsD> islands = Islands::Split(bridgeArea);
+    for (Clipper2Lib::PathsD &island : islands)
+    {
+        Clipper2Lib::PathsD islandUnsupported = Clipper2Lib::Intersect(unsupported, island, Clipper2Lib::FillRule::NonZero);
+        if (islandUnsupported.size() == 0)
+        {
+            continue;
+        }
+
+        Clipper2Lib::PathsD islandSupported = Clipper2Lib::Difference(island, islandUnsupported, Clipper2Lib::FillRule::NonZero);
+
+        // the direction only has to be found roughly, sample it with fewer lines than are printed
+        double angle = FindBridgeAngle(infillCreator, islandUnsupported, islandSupported, spacing * 2);
+
+        Clipper2Lib::PathsD lines = CreateInfill::CreateScanlines(Clipper2Lib::GetBounds(island), spacing, angle);
+        Clipper2Lib::PathsD islandBridges = infillCreator.ClipInfill(lines, island);
+        if (settings.GetConnectInfill())
+        {
+            islandBridges = ConnectInfill::Connect(islandBridges, island, spacing * 3);
+        }
+        bridges.insert(bridges.end(), islandBridges.begin(), islandBridges.end());
+    }
+
+    return bridges;
+}
+
+#endif
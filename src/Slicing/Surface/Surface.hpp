@@ -9,11 +9,10 @@
 class Surface
 {
 private:
-    static Clipper2Lib::PathsD CalculateSliceSurface(Clipper2Lib::PathsD &curSlice, vector<Clipper2Lib::PathsD> adjacentSlices);
+    static Clipper2Lib::PathsD CalculateSliceSurface(Clipper2Lib::PathsD &curSlice, Clipper2Lib::PathsD *cover);
     static Clipper2Lib::PathsD CalculateFloors(Clipper2Lib::PathsD &curSlice, vector<Clipper2Lib::PathsD> adjacentSlices);
 
     static void FilterArtifacts(Clipper2Lib::PathsD &paths, double epsilon);
-    static Clipper2Lib::PathsD IntersectAdjacentSlices(vector<Clipper2Lib::PathsD> adjacentSlices);
 
     static void printPaths(Clipper2Lib::PathsD paths)
     {
@@ -27,46 +26,117 @@ private:
     };
 
 public:
-    static Clipper2Lib::PathsD CalculateSurface(Clipper2Lib::PathsD curSlice, vector<Clipper2Lib::PathsD> floorAdjacences, vector<Clipper2Lib::PathsD> roofAdjacences);
+    static Clipper2Lib::PathsD CalculateSurface(Clipper2Lib::PathsD &curSlice, Clipper2Lib::PathsD *floorCover, Clipper2Lib::PathsD *roofCover);
+    static vector<Clipper2Lib::PathsD> IntersectWindows(vector<Clipper2Lib::PathsD> &layers, int size);
+    static vector<Clipper2Lib::PathsD> CalculateRoofDistances(Clipper2Lib::PathsD &curSlice, vector<Clipper2Lib::PathsD *> &roofCovers);
 
 };
 
-Clipper2Lib::PathsD Surface::CalculateSurface(Clipper2Lib::PathsD curSlice, vector<Clipper2Lib::PathsD> floorAdjacences, vector<Clipper2Lib::PathsD> roofAdjacences)
+Clipper2Lib::PathsD Surface::CalculateSurface(Clipper2Lib::PathsD &curSlice, Clipper2Lib::PathsD *floorCover, Clipper2Lib::PathsD *roofCover)
 {
-    //Clipper2Lib::PathsD result;
+    //a cover is the intersection of the inner walls of the layers below (floors) or above (roofs), nullptr when there are no floors or roofs
     Clipper2Lib::PathsD surface;
     //Calculate floors
-    Clipper2Lib::PathsD floors = CalculateSliceSurface(curSlice, floorAdjacences);
+    Clipper2Lib::PathsD floors = CalculateSliceSurface(curSlice, floorCover);
     //Calculate roofs
-    Clipper2Lib::PathsD roofs = CalculateSliceSurface(curSlice, roofAdjacences);
+    Clipper2Lib::PathsD roofs = CalculateSliceSurface(curSlice, roofCover);
     //Union result with surface
     surface = Clipper2Lib::Union(floors, roofs, Clipper2Lib::FillRule::EvenOdd);
 
     return surface;
 };
 
-Clipper2Lib::PathsD Surface::CalculateSliceSurface(Clipper2Lib::PathsD &curSlice, vector<Clipper2Lib::PathsD> adjacentSlices)
+vector<Clipper2Lib::PathsD> Surface::IntersectWindows(vector<Clipper2Lib::PathsD> &layers, int size)
 {
-    //curslice is innerwall of the layer offsetted by nozzle diameter -> always prints extra inner wall on surfaces
-    //adjacent is inner wall of the next layers
+    //result[i] is the intersection of layers[i] up to layers[i + size - 1]
+    //the layers are split in blocks of size layers, every window covers the end of one block and the start of the next,
+    //so it is the intersection of a suffix and a prefix of those blocks (van Herk / Gil-Werman)
+    //this takes about 3 intersections per layer, whatever the window size
+    vector<Clipper2Lib::PathsD> windows;
+    int n = layers.size();
+    if (size <= 0 || size > n)
+    {
+        return windows;
+    }
+
+    vector<Clipper2Lib::PathsD> prefix(n);
+    vector<Clipper2Lib::PathsD> suffix(n);
+    int blocks = (n + size - 1) / size;
+    #pragma omp parallel for
+    for (int b = 0; b < blocks; b++)
+    {
+        int first = b * size;
+        int last = min(first + size, n) - 1;
+
+        prefix[first] = layers[first];
+        for (int j = first + 1; j <= last; j++)
+        {
+            if (prefix[j - 1].size() > 0)
+            {
+                prefix[j] = Clipper2Lib::Intersect(prefix[j - 1], layers[j], Clipper2Lib::FillRule::EvenOdd);
+            }
+        }
+
+        suffix[last] = layers[last];
+        for (int j = last - 1; j >= first; j--)
+        {
+            if (suffix[j + 1].size() > 0)
+            {
+                suffix[j] = Clipper2Lib::Intersect(layers[j], suffix[j + 1], Clipper2Lib::FillRule::EvenOdd);
+            }
+        }
+    }
+
+    windows.resize(n - size + 1);
+    #pragma omp parallel for
+    for (int i = 0; i < windows.size(); i++)
+    {
+        if (i % size == 0)
+        {
+            //the window is exactly one block
+            windows[i] = suffix[i];
+        }
+        else if (suffix[i].size() > 0 && prefix[i + size - 1].size() > 0)
+        {
+            windows[i] = Clipper2Lib::Intersect(suffix[i], prefix[i + size - 1], Clipper2Lib::FillRule::EvenOdd);
+        }
+    }
+
+    return windows;
+};
 
-    //compare innerwalls of current slice with outerwalls of adjacent slices
+vector<Clipper2Lib::PathsD> Surface::CalculateRoofDistances(Clipper2Lib::PathsD &curSlice, vector<Clipper2Lib::PathsD *> &roofCovers)
+{
+    //roofCovers[k] is the intersection of the (k+1)*stepLayers layers above this one
+    //result[k] is the part of curSlice that has a roof within (k+1)*stepLayers layers above it
+    //the areas grow with k, every area contains the previous ones
+    vector<Clipper2Lib::PathsD> distances;
+    for (int k = 0; k < roofCovers.size(); k++)
+    {
+        Clipper2Lib::PathsD distance = Clipper2Lib::Difference(curSlice, *roofCovers[k], Clipper2Lib::FillRule::EvenOdd);
+        FilterArtifacts(distance, 0.2);
+        distances.push_back(distance);
+    }
+
+    return distances;
+};
+
+Clipper2Lib::PathsD Surface::CalculateSliceSurface(Clipper2Lib::PathsD &curSlice, Clipper2Lib::PathsD *cover)
+{
+    //curslice is innerwall of the layer offsetted by nozzle diameter -> always prints extra inner wall on surfaces
+    //cover is the intersection of the inner walls of the adjacent layers, everything of curslice outside of it is a surface
     Clipper2Lib::PathsD surface;
-    
-    if (adjacentSlices.size() == 0)
+
+    if (cover == nullptr)
     {
         return surface;
     }
 
-    // intersect adjacent slices
-    Clipper2Lib::PathsD adjacentIntersected = IntersectAdjacentSlices(adjacentSlices);
-    Clipper2Lib::PathsD result =  Clipper2Lib::Difference(curSlice, adjacentIntersected, Clipper2Lib::FillRule::EvenOdd);
+    surface = Clipper2Lib::Difference(curSlice, *cover, Clipper2Lib::FillRule::EvenOdd);
 
-    FilterArtifacts(result, 0.2);
-    //Union result with surface
-    surface = Clipper2Lib::Union(surface, result, Clipper2Lib::FillRule::EvenOdd);
-    
-    return result;
+    FilterArtifacts(surface, 0.2);
+
+    return surface;
 };
 
 Clipper2Lib::PathsD Surface::CalculateFloors(Clipper2Lib::PathsD &curSlice, vector<Clipper2Lib::PathsD> adjacentSlices)
@@ -86,17 +156,6 @@ Clipper2Lib::PathsD Surface::CalculateFloors(Clipper2Lib::PathsD &curSlice, vect
     return surface;
 };
 
-Clipper2Lib::PathsD Surface::IntersectAdjacentSlices(vector<Clipper2Lib::PathsD> adjacentSlices)
-{
-    Clipper2Lib::PathsD result = adjacentSlices[0];
-    for (int i = 1; i < adjacentSlices.size(); i++)
-    {
-        result = Clipper2Lib::Intersect(result, adjacentSlices[i], Clipper2Lib::FillRule::EvenOdd);
-    }
-
-    return result;
-};
-
 void Surface::FilterArtifacts(Clipper2Lib::PathsD &paths, double epsilon)
 {
     for (int i = 0; i < paths.size(); i++)
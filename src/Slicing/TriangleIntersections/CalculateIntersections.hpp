@@ -25,6 +25,8 @@ private:
     static void SortByHeight(vector<Vertex> &triangleVertices);
 
     static vector<VertexPair> CalculatePairs(vector<Vertex> &vertices, double intersectionHeight);
+    static vector<VertexPair> CalculatePairs(vector<glm::vec3> &corners, double intersectionHeight);
+    static Clipper2Lib::PathsD ToClipperPaths(vector<VertexPair> &vertexPairs);
     static vector<VertexLine> CalculateLines(vector<VertexPair> &vertexPairs);
     static void GroupLine(vector<VertexPair> &vertexPairs, VertexLine &line);
 
@@ -35,6 +37,7 @@ public:
     static vector<VertexLine> CalculateLines(vector<Vertex> &vertices, float intersectionHeight);
 
     static Clipper2Lib::PathsD CalculateClipperPaths(vector<Vertex> &lines, SlicerSettings settings, double intersectionHeight);
+    static Clipper2Lib::PathsD CalculateClipperPaths(vector<glm::vec3> &corners, SlicerSettings settings, double intersectionHeight);
 };
 
 vector<VertexLine> CalculateIntersections::CalculateLines(vector<Vertex> &vertices, float intersectionHeight)
@@ -115,6 +118,26 @@ vector<VertexPair> CalculateIntersections::CalculatePairs(vector<Vertex> &vertic
     return vertexPairs;
 }
 
+vector<VertexPair> CalculateIntersections::CalculatePairs(vector<glm::vec3> &corners, double intersectionHeight){
+    // bare corners, three per triangle, are turned into vertices a chunk of triangles at a time,
+    // a mesh that is only kept as corners is never widened to vertices as a whole
+    const int chunkTriangles = 4096;
+    vector<VertexPair> vertexPairs;
+    vector<Vertex> chunk;
+    for (int start = 0; start + 2 < corners.size(); start += chunkTriangles * 3)
+    {
+        int end = min((int)corners.size() / 3 * 3, start + chunkTriangles * 3);
+        chunk.resize(end - start);
+        for (int i = start; i < end; i++)
+        {
+            chunk[i - start].Position = corners[i];
+        }
+        vector<VertexPair> chunkPairs = CalculatePairs(chunk, intersectionHeight);
+        vertexPairs.insert(vertexPairs.end(), chunkPairs.begin(), chunkPairs.end());
+    }
+    return vertexPairs;
+}
+
 vector<VertexLine> CalculateIntersections::CalculateLines(vector<VertexPair> &vertexPairs)
 {
     // create a line for all connecting pairs
@@ -186,7 +209,17 @@ Clipper2Lib::PathsD CalculateIntersections::CalculateClipperPaths(vector<Vertex>
 {
     // first find all triangle intersecting lines using the calculatePairs function
     vector<VertexPair> vertexPairs = CalculatePairs(lines, intersectionHeight);
+    return ToClipperPaths(vertexPairs);
+}
+
+Clipper2Lib::PathsD CalculateIntersections::CalculateClipperPaths(vector<glm::vec3> &corners, SlicerSettings settings, double intersectionHeight)
+{
+    vector<VertexPair> vertexPairs = CalculatePairs(corners, intersectionHeight);
+    return ToClipperPaths(vertexPairs);
+}
 
+Clipper2Lib::PathsD CalculateIntersections::ToClipperPaths(vector<VertexPair> &vertexPairs)
+{
     // then group the pairs into lines
     vector<VertexLine> vertexLines = CalculateLines(vertexPairs);
 
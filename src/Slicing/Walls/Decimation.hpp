@@ -0,0 +1,248 @@
+#ifndef DECIMATION_HPP
+#define DECIMATION_HPP
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "clipper2/clipper.h"
+
+// removes the points of closed contours that the printer can not resolve
+// finely tessellated models give contours with thousands of tiny segments, the planner of the printer can not keep up with those
+// points are removed as long as the contour stays within the maximum deviation of the original,
+// a contour that would cross itself or another contour is kept as it was
+class Decimation
+{
+private:
+    struct Segment
+    {
+        int path;
+        Clipper2Lib::PointD a;
+        Clipper2Lib::PointD b;
+    };
+
+    static vector<int> DouglasPeucker(const Clipper2Lib::PathD &path, double maxDeviation);
+    static void RemoveShortSegments(const Clipper2Lib::PathD &path, vector<int> &kept, double maxDeviation, double minSegmentLength);
+    static double Deviation(const Clipper2Lib::PathD &path, int from, int to);
+    static double SegmentDistance(Clipper2Lib::PointD point, Clipper2Lib::PointD a, Clipper2Lib::PointD b);
+    static vector<bool> FindCrossings(const Clipper2Lib::PathsD &paths);
+    static bool Cross(const Segment &s, const Segment &t);
+
+public:
+    static Clipper2Lib::PathsD Decimate(const Clipper2Lib::PathsD &paths, double maxDeviation, double minSegmentLength);
+};
+
+Clipper2Lib::PathsD Decimation::Decimate(const Clipper2Lib::PathsD &paths, double maxDeviation, double minSegmentLength)
+{
+    Clipper2Lib::PathsD decimated(paths.size());
+    for (int i = 0; i < paths.size(); i++)
+    {
+        if (paths[i].size() <= 3)
+        {
+            decimated[i] = paths[i];
+            continue;
+        }
+
+        vector<int> kept = DouglasPeucker(paths[i], maxDeviation);
+        RemoveShortSegments(paths[i], kept, maxDeviation, minSegmentLength);
+
+        // a contour needs at least three points to keep its area
+        if (kept.size() < 3)
+        {
+            decimated[i] = paths[i];
+            continue;
+        }
+        for (int index : kept)
+        {
+            decimated[i].push_back(paths[i][index]);
+        }
+    }
+
+    // contours that cross after decimation go back to their original points, that can make them cross other decimated contours
+    for (int attempt = 0; attempt < 3; attempt++)
+    {
+        vector<bool> crossing = FindCrossings(decimated);
+        bool restored = false;
+        for (int i = 0; i < paths.size(); i++)
+        {
+            if (crossing[i] && decimated[i].size() != paths[i].size())
+            {
+                decimated[i] = paths[i];
+                restored = true;
+            }
+        }
+        if (!restored)
+        {
+            break;
+        }
+    }
+
+    return decimated;
+}
+
+vector<int> Decimation::DouglasPeucker(const Clipper2Lib::PathD &path, double maxDeviation)
+{
+    // a closed contour is split at its first point and the point furthest away from it
+    int n = path.size();
+    int far = 0;
+    double farDistance = 0;
+    for (int i = 1; i < n; i++)
+    {
+        double distance = sqrt(pow(path[i].x - path[0].x, 2) + pow(path[i].y - path[0].y, 2));
+        if (distance > farDistance)
+        {
+            farDistance = distance;
+            far = i;
+        }
+    }
+
+    vector<bool> keep(n, false);
+    keep[0] = true;
+    keep[far] = true;
+
+    // ranges still to check, the end of a range wraps around to the first point
+    vector<pair<int, int>> ranges = {{0, far}, {far, n}};
+    while (ranges.size() > 0)
+    {
+        pair<int, int> range = ranges.back();
+        ranges.pop_back();
+        if (range.second - range.first < 2)
+        {
+            continue;
+        }
+
+        Clipper2Lib::PointD a = path[range.first];
+        Clipper2Lib::PointD b = path[range.second % n];
+        int furthest = -1;
+        double furthestDistance = maxDeviation;
+        for (int i = range.first + 1; i < range.second; i++)
+        {
+            double distance = SegmentDistance(path[i], a, b);
+            if (distance > furthestDistance)
+            {
+                furthestDistance = distance;
+                furthest = i;
+            }
+        }
+
+        if (furthest != -1)
+        {
+            keep[furthest] = true;
+            ranges.push_back({range.first, furthest});
+            ranges.push_back({furthest, range.second});
+        }
+    }
+
+    vector<int> kept;
+    for (int i = 0; i < n; i++)
+    {
+        if (keep[i])
+        {
+            kept.push_back(i);
+        }
+    }
+    return kept;
+}
+
+void Decimation::RemoveShortSegments(const Clipper2Lib::PathD &path, vector<int> &kept, double maxDeviation, double minSegmentLength)
+{
+    // douglas peucker splits from the top down and keeps points a local check would drop,
+    // a point at the end of a segment that is too short goes when the original points stay within the deviation without it,
+    // the contour is closed so the last segment runs from the last kept point back to the first one
+    int k = 1;
+    while (k <= kept.size() && kept.size() > 3)
+    {
+        int end = k % kept.size();
+        Clipper2Lib::PointD previous = path[kept[k - 1]];
+        Clipper2Lib::PointD current = path[kept[end]];
+        double length = sqrt(pow(current.x - previous.x, 2) + pow(current.y - previous.y, 2));
+        int next = kept[(k + 1) % kept.size()];
+        if (length < minSegmentLength && Deviation(path, kept[k - 1], next) <= maxDeviation)
+        {
+            kept.erase(kept.begin() + end);
+        }
+        else
+        {
+            k++;
+        }
+    }
+}
+
+double Decimation::Deviation(const Clipper2Lib::PathD &path, int from, int to)
+{
+    // furthest original point between from and to, measured to the segment that replaces them
+    int n = path.size();
+    Clipper2Lib::PointD a = path[from];
+    Clipper2Lib::PointD b = path[to];
+    double deviation = 0;
+    for (int i = (from + 1) % n; i != to; i = (i + 1) % n)
+    {
+        deviation = max(deviation, SegmentDistance(path[i], a, b));
+    }
+    return deviation;
+}
+
+double Decimation::SegmentDistance(Clipper2Lib::PointD point, Clipper2Lib::PointD a, Clipper2Lib::PointD b)
+{
+    double dx = b.x - a.x;
+    double dy = b.y - a.y;
+    double lengthSquared = dx * dx + dy * dy;
+    double t = lengthSquared == 0 ? 0 : ((point.x - a.x) * dx + (point.y - a.y) * dy) / lengthSquared;
+    t = max(0.0, min(1.0, t));
+    return sqrt(pow(point.x - (a.x + t * dx), 2) + pow(point.y - (a.y + t * dy), 2));
+}
+
+vector<bool> Decimation::FindCrossings(const Clipper2Lib::PathsD &paths)
+{
+    vector<Segment> segments;
+    for (int i = 0; i < paths.size(); i++)
+    {
+        for (int j = 0; j < paths[i].size(); j++)
+        {
+            segments.push_back({i, paths[i][j], paths[i][(j + 1) % paths[i].size()]});
+        }
+    }
+
+    // sweep from left to right, only segments that overlap in x can cross
+    sort(segments.begin(), segments.end(), [](const Segment &s, const Segment &t) {
+        return min(s.a.x, s.b.x) < min(t.a.x, t.b.x);
+    });
+
+    vector<bool> crossing(paths.size(), false);
+    for (int s = 0; s < segments.size(); s++)
+    {
+        double right = max(segments[s].a.x, segments[s].b.x);
+        for (int t = s + 1; t < segments.size() && min(segments[t].a.x, segments[t].b.x) <= right; t++)
+        {
+            if (Cross(segments[s], segments[t]))
+            {
+                crossing[segments[s].path] = true;
+                crossing[segments[t].path] = true;
+            }
+        }
+    }
+    return crossing;
+}
+
+bool Decimation::Cross(const Segment &s, const Segment &t)
+{
+    // neighbouring segments of a contour share a point
+    if (s.path == t.path && (s.b == t.a || t.b == s.a))
+    {
+        return false;
+    }
+    if (max(s.a.y, s.b.y) < min(t.a.y, t.b.y) || max(t.a.y, t.b.y) < min(s.a.y, s.b.y))
+    {
+        return false;
+    }
+
+    double d1 = Clipper2Lib::CrossProduct(s.a, s.b, t.a);
+    double d2 = Clipper2Lib::CrossProduct(s.a, s.b, t.b);
+    double d3 = Clipper2Lib::CrossProduct(t.a, t.b, s.a);
+    double d4 = Clipper2Lib::CrossProduct(t.a, t.b, s.b);
+
+    // touching counts as crossing, the contours would be printed on top of each other
+    // collinear segments get here only when their bounds overlap, so they overlap as well
+    return ((d1 <= 0 && d2 >= 0) || (d1 >= 0 && d2 <= 0)) && ((d3 <= 0 && d4 >= 0) || (d3 >= 0 && d4 <= 0));
+}
+
+#endif
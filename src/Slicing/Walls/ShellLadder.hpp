@@ -0,0 +1,66 @@
+#ifndef SHELLLADDER_HPP
+#define SHELLLADDER_HPP
+
+#include <vector>
+#include <cmath>
+#include "clipper2/clipper.h"
+
+// several offsets of the same paths from one offset engine
+// the paths are added to the engine once and every offset only runs Execute with another delta,
+// the engine is kept per thread so its buffers are reused for every layer instead of being rebuilt for every offset
+class ShellLadder
+{
+private:
+    static const int precision = 2; //same precision as Clipper2Lib::InflatePaths
+
+    static Clipper2Lib::ClipperOffset &GetEngine();
+
+public:
+    static vector<Clipper2Lib::PathsD> Offset(const Clipper2Lib::PathsD &paths, const vector<double> &deltas, Clipper2Lib::JoinType joinType = Clipper2Lib::JoinType::Miter, double miterLimit = 2.0);
+    static Clipper2Lib::PathsD Offset(const Clipper2Lib::PathsD &paths, double delta, Clipper2Lib::JoinType joinType = Clipper2Lib::JoinType::Miter, double miterLimit = 2.0);
+};
+
+Clipper2Lib::ClipperOffset &ShellLadder::GetEngine()
+{
+    static thread_local Clipper2Lib::ClipperOffset engine;
+    return engine;
+}
+
+vector<Clipper2Lib::PathsD> ShellLadder::Offset(const Clipper2Lib::PathsD &paths, const vector<double> &deltas, Clipper2Lib::JoinType joinType, double miterLimit)
+{
+    vector<Clipper2Lib::PathsD> result(deltas.size());
+    if (paths.size() == 0)
+    {
+        return result;
+    }
+
+    const double scale = pow(10, precision);
+    int errorCode = 0;
+    Clipper2Lib::Paths64 scaled = Clipper2Lib::ScalePaths<int64_t, double>(paths, scale, errorCode);
+    if (errorCode)
+    {
+        return result;
+    }
+
+    Clipper2Lib::ClipperOffset &engine = GetEngine();
+    engine.Clear();
+    engine.MiterLimit(miterLimit);
+    engine.AddPaths(scaled, joinType, Clipper2Lib::EndType::Polygon);
+
+    Clipper2Lib::Paths64 solution;
+    for (int i = 0; i < deltas.size(); i++)
+    {
+        engine.Execute(deltas[i] * scale, solution);
+        result[i] = Clipper2Lib::ScalePaths<double, int64_t>(solution, 1 / scale, errorCode);
+    }
+    engine.Clear();
+
+    return result;
+}
+
+Clipper2Lib::PathsD ShellLadder::Offset(const Clipper2Lib::PathsD &paths, double delta, Clipper2Lib::JoinType joinType, double miterLimit)
+{
+    return Offset(paths, vector<double>{delta}, joinType, miterLimit)[0];
+}
+
+#endif
@@ -0,0 +1,625 @@
+#ifndef VARIABLEWIDTHWALLS_HPP
+#define VARIABLEWIDTHWALLS_HPP
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "clipper2/clipper.h"
+#include "ShellLadder.hpp"
+#include "../Islands/Islands.hpp"
+
+// open polyline that is extruded with a different width at every vertex
+struct VariableWidthPath
+{
+    Clipper2Lib::PathD path;
+    vector<double> widths;
+};
+
+// centre lines of areas that are too thin for regular walls
+// the area is rasterized and thinned to its skeleton (medial axis), the width of a line is twice the distance to the border of the area
+class VariableWidthWalls
+{
+private:
+    struct Raster
+    {
+        int width;
+        int height;
+        double left;
+        double top;
+        double pixelSize;
+        vector<unsigned char> inside;
+        vector<double> distance; //distance to the closest pixel outside the area, in pixels
+
+        int Index(int x, int y) { return y * width + x; }
+    };
+
+    static void Rasterize(Clipper2Lib::PathsD &area, Raster &raster);
+    static void DistanceTransform(Raster &raster);
+    static void DistanceTransform1D(vector<double> &values, int count);
+
+    static void Thin(Raster &raster, vector<unsigned char> &skeleton);
+    static void RemoveRedundantPixels(Raster &raster, vector<unsigned char> &skeleton);
+    static void PruneSpurs(Raster &raster, vector<unsigned char> &skeleton);
+    static vector<vector<int>> TraceSkeleton(Raster &raster, vector<unsigned char> &skeleton);
+
+    static int Neighbours(Raster &raster, vector<unsigned char> &skeleton, int index, int *neighbours);
+    static VariableWidthPath ToPath(Raster &raster, vector<int> &pixels);
+    static void Simplify(VariableWidthPath &path, double tolerance);
+
+public:
+    static vector<VariableWidthPath> CreateCenterLines(Clipper2Lib::PathsD &area, double minWidth, double maxWidth, double pixelSize);
+};
+
+vector<VariableWidthPath> VariableWidthWalls::CreateCenterLines(Clipper2Lib::PathsD &area, double minWidth, double maxWidth, double pixelSize)
+{
+    vector<VariableWidthPath> result;
+    if (area.size() == 0)
+    {
+        return result;
+    }
+
+    // slivers thinner than the minimum width (e.g. along walls) would only make the rasters large
+    Clipper2Lib::PathsD printable = ShellLadder::Offset(area, -minWidth / 2, Clipper2Lib::JoinType::Round);
+    printable = ShellLadder::Offset(printable, minWidth / 2, Clipper2Lib::JoinType::Round);
+
+    // every island gets its own raster, so far apart thin parts do not create one huge raster
+    for (Clipper2Lib::PathsD &island : Islands::Split(printable))
+    {
+        Clipper2Lib::RectD bounds = Clipper2Lib::GetBounds(island);
+        if (bounds.Width() < minWidth || bounds.Height() < minWidth)
+        {
+            continue;
+        }
+
+        // limit the raster size for long diagonal features
+        Raster raster;
+        raster.pixelSize = max(pixelSize, sqrt(bounds.Width() * bounds.Height() / 4000000.0));
+        raster.left = bounds.left - 2 * raster.pixelSize;
+        raster.top = bounds.top - 2 * raster.pixelSize;
+        raster.width = (int)ceil(bounds.Width() / raster.pixelSize) + 4;
+        raster.height = (int)ceil(bounds.Height() / raster.pixelSize) + 4;
+
+        Rasterize(island, raster);
+        DistanceTransform(raster);
+
+        vector<unsigned char> skeleton;
+        Thin(raster, skeleton);
+        RemoveRedundantPixels(raster, skeleton);
+        PruneSpurs(raster, skeleton);
+
+        for (vector<int> &pixels : TraceSkeleton(raster, skeleton))
+        {
+            VariableWidthPath line = ToPath(raster, pixels);
+
+            // split the line where it is too thin to print
+            VariableWidthPath part;
+            for (int i = 0; i <= line.path.size(); i++)
+            {
+                if (i < line.path.size() && line.widths[i] >= minWidth)
+                {
+                    part.path.push_back(line.path[i]);
+                    part.widths.push_back(min(line.widths[i], maxWidth));
+                    continue;
+                }
+
+                double length = 0;
+                for (int k = 1; k < part.path.size(); k++)
+                {
+                    length += sqrt(pow(part.path[k].x - part.path[k - 1].x, 2) + pow(part.path[k].y - part.path[k - 1].y, 2));
+                }
+                if (part.path.size() >= 2 && length >= minWidth)
+                {
+                    Simplify(part, raster.pixelSize);
+                    result.push_back(part);
+                }
+                part = VariableWidthPath();
+            }
+        }
+    }
+
+    return result;
+}
+
+void VariableWidthWalls::Rasterize(Clipper2Lib::PathsD &area, Raster &raster)
+{
+    raster.inside.assign(raster.width * raster.height, 0);
+
+    // even-odd scanline fill through the pixel centres
+    vector<double> crossings;
+    for (int y = 0; y < raster.height; y++)
+    {
+        double centerY = raster.top + (y + 0.5) * raster.pixelSize;
+        crossings.clear();
+        for (Clipper2Lib::PathD &path : area)
+        {
+            for (int i = 0; i < path.size(); i++)
+            {
+                Clipper2Lib::PointD a = path[i];
+                Clipper2Lib::PointD b = path[(i + 1) % path.size()];
+                if ((a.y <= centerY) != (b.y <= centerY))
+                {
+                    crossings.push_back(a.x + (centerY - a.y) * (b.x - a.x) / (b.y - a.y));
+                }
+            }
+        }
+        sort(crossings.begin(), crossings.end());
+
+        for (int i = 0; i + 1 < crossings.size(); i += 2)
+        {
+            int start = max(0, (int)ceil((crossings[i] - raster.left) / raster.pixelSize - 0.5));
+            int end = min(raster.width - 1, (int)floor((crossings[i + 1] - raster.left) / raster.pixelSize - 0.5));
+            for (int x = start; x <= end; x++)
+            {
+                raster.inside[raster.Index(x, y)] = 1;
+            }
+        }
+    }
+}
+
+void VariableWidthWalls::DistanceTransform(Raster &raster)
+{
+    // exact euclidean distance transform, separable in columns and rows (Felzenszwalb & Huttenlocher)
+    const double infinity = 1e20;
+    raster.distance.resize(raster.width * raster.height);
+    for (int i = 0; i < raster.distance.size(); i++)
+    {
+        raster.distance[i] = raster.inside[i] ? infinity : 0;
+    }
+
+    vector<double> values(max(raster.width, raster.height));
+    for (int x = 0; x < raster.width; x++)
+    {
+        for (int y = 0; y < raster.height; y++)
+        {
+            values[y] = raster.distance[raster.Index(x, y)];
+        }
+        DistanceTransform1D(values, raster.height);
+        for (int y = 0; y < raster.height; y++)
+        {
+            raster.distance[raster.Index(x, y)] = values[y];
+        }
+    }
+    for (int y = 0; y < raster.height; y++)
+    {
+        for (int x = 0; x < raster.width; x++)
+        {
+            values[x] = raster.distance[raster.Index(x, y)];
+        }
+        DistanceTransform1D(values, raster.width);
+        for (int x = 0; x < raster.width; x++)
+        {
+            raster.distance[raster.Index(x, y)] = sqrt(values[x]);
+        }
+    }
+}
+
+void VariableWidthWalls::DistanceTransform1D(vector<double> &values, int count)
+{
+    // lower envelope of the parabolas rooted at every sample
+    vector<double> result(count);
+    vector<int> roots(count);
+    vector<double> bounds(count + 1);
+    int k = 0;
+    roots[0] = 0;
+    bounds[0] = -1e20;
+    bounds[1] = 1e20;
+    for (int q = 1; q < count; q++)
+    {
+        double s = ((values[q] + q * q) - (values[roots[k]] + roots[k] * roots[k])) / (2.0 * q - 2.0 * roots[k]);
+        while (s <= bounds[k])
+        {
+            k--;
+            s = ((values[q] + q * q) - (values[roots[k]] + roots[k] * roots[k])) / (2.0 * q - 2.0 * roots[k]);
+        }
+        k++;
+        roots[k] = q;
+        bounds[k] = s;
+        bounds[k + 1] = 1e20;
+    }
+
+    k = 0;
+    for (int q = 0; q < count; q++)
+    {
+        while (bounds[k + 1] < q)
+        {
+            k++;
+        }
+        result[q] = (q - roots[k]) * (q - roots[k]) + values[roots[k]];
+    }
+    for (int q = 0; q < count; q++)
+    {
+        values[q] = result[q];
+    }
+}
+
+int VariableWidthWalls::Neighbours(Raster &raster, vector<unsigned char> &skeleton, int index, int *neighbours)
+{
+    // clockwise starting north: N, NE, E, SE, S, SW, W, NW
+    static const int dx[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+    static const int dy[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+    int x = index % raster.width;
+    int y = index / raster.width;
+    int count = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        int n = raster.Index(x + dx[i], y + dy[i]);
+        neighbours[i] = skeleton[n] ? n : -1;
+        count += skeleton[n] ? 1 : 0;
+    }
+    return count;
+}
+
+void VariableWidthWalls::Thin(Raster &raster, vector<unsigned char> &skeleton)
+{
+    // Zhang-Suen thinning, the border of the raster is always outside the area
+    skeleton = raster.inside;
+    int neighbours[8];
+
+    // only pixels on the border of the area can be removed, so only those are checked
+    vector<int> candidates;
+    vector<unsigned char> queued(skeleton.size(), 0);
+    for (int index = 0; index < skeleton.size(); index++)
+    {
+        if (skeleton[index] && Neighbours(raster, skeleton, index, neighbours) < 8)
+        {
+            candidates.push_back(index);
+            queued[index] = 1;
+        }
+    }
+
+    vector<int> removable;
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (int step = 0; step < 2; step++)
+        {
+            removable.clear();
+            for (int index : candidates)
+            {
+                int count = Neighbours(raster, skeleton, index, neighbours);
+                if (count < 2 || count > 6)
+                {
+                    continue;
+                }
+                int transitions = 0;
+                for (int i = 0; i < 8; i++)
+                {
+                    if (neighbours[i] == -1 && neighbours[(i + 1) % 8] != -1)
+                    {
+                        transitions++;
+                    }
+                }
+                if (transitions != 1)
+                {
+                    continue;
+                }
+                bool n = neighbours[0] != -1, e = neighbours[2] != -1, s = neighbours[4] != -1, w = neighbours[6] != -1;
+                if (step == 0 && !(n && e && s) && !(e && s && w))
+                {
+                    removable.push_back(index);
+                }
+                else if (step == 1 && !(n && e && w) && !(n && s && w))
+                {
+                    removable.push_back(index);
+                }
+            }
+            for (int index : removable)
+            {
+                skeleton[index] = 0;
+            }
+            changed = changed || removable.size() > 0;
+
+            // removing a pixel exposes its neighbours
+            vector<int> next;
+            for (int index : candidates)
+            {
+                if (skeleton[index])
+                {
+                    next.push_back(index);
+                }
+            }
+            for (int index : removable)
+            {
+                Neighbours(raster, skeleton, index, neighbours);
+                for (int i = 0; i < 8; i++)
+                {
+                    if (neighbours[i] != -1 && !queued[neighbours[i]])
+                    {
+                        queued[neighbours[i]] = 1;
+                        next.push_back(neighbours[i]);
+                    }
+                }
+            }
+            candidates = next;
+        }
+    }
+}
+
+void VariableWidthWalls::RemoveRedundantPixels(Raster &raster, vector<unsigned char> &skeleton)
+{
+    // thinning leaves staircase corners where a pixel has three neighbours without being a junction
+    // a pixel is redundant when its neighbours stay connected without it
+    int neighbours[8];
+    for (int index = 0; index < skeleton.size(); index++)
+    {
+        if (!skeleton[index] || Neighbours(raster, skeleton, index, neighbours) < 2)
+        {
+            continue;
+        }
+
+        vector<int> group(8, -1);
+        int groups = 0;
+        for (int i = 0; i < 8; i++)
+        {
+            if (neighbours[i] == -1 || group[i] != -1)
+            {
+                continue;
+            }
+            groups++;
+            vector<int> stack = {i};
+            group[i] = groups;
+            while (stack.size() > 0)
+            {
+                int current = stack.back();
+                stack.pop_back();
+                // neighbours touch when they are next to each other on the ring, or when both are direct neighbours with one diagonal in between
+                int candidates[4] = {(current + 1) % 8, (current + 7) % 8, current % 2 == 0 ? (current + 2) % 8 : -1, current % 2 == 0 ? (current + 6) % 8 : -1};
+                for (int candidate : candidates)
+                {
+                    if (candidate != -1 && neighbours[candidate] != -1 && group[candidate] == -1)
+                    {
+                        group[candidate] = groups;
+                        stack.push_back(candidate);
+                    }
+                }
+            }
+        }
+
+        if (groups == 1)
+        {
+            skeleton[index] = 0;
+        }
+    }
+}
+
+void VariableWidthWalls::PruneSpurs(Raster &raster, vector<unsigned char> &skeleton)
+{
+    // the skeleton branches off to every convex corner of the area
+    // a branch that ends within the inscribed circle of the junction it starts from is such a spur
+    int neighbours[8];
+    for (int pass = 0; pass < 3; pass++)
+    {
+        bool pruned = false;
+        for (int index = 0; index < skeleton.size(); index++)
+        {
+            if (!skeleton[index] || Neighbours(raster, skeleton, index, neighbours) != 1)
+            {
+                continue;
+            }
+
+            vector<int> branch = {index};
+            double length = 0;
+            int previous = -1;
+            int current = index;
+            int junction = -1;
+            while (junction == -1)
+            {
+                int count = Neighbours(raster, skeleton, current, neighbours);
+                int next = -1;
+                for (int i = 0; i < 8; i++)
+                {
+                    if (neighbours[i] != -1 && neighbours[i] != previous && next == -1)
+                    {
+                        next = neighbours[i];
+                    }
+                }
+                if (current != index && count >= 3)
+                {
+                    junction = current;
+                    branch.pop_back();
+                    break;
+                }
+                if (next == -1 || next == index)
+                {
+                    break;
+                }
+                length += (next % raster.width != current % raster.width && next / raster.width != current / raster.width) ? sqrt(2) : 1;
+                previous = current;
+                current = next;
+                branch.push_back(current);
+            }
+
+            if (junction != -1 && length <= raster.distance[junction])
+            {
+                for (int pixel : branch)
+                {
+                    skeleton[pixel] = 0;
+                }
+                pruned = true;
+            }
+        }
+
+        if (!pruned)
+        {
+            break;
+        }
+        RemoveRedundantPixels(raster, skeleton);
+    }
+}
+
+vector<vector<int>> VariableWidthWalls::TraceSkeleton(Raster &raster, vector<unsigned char> &skeleton)
+{
+    // split the skeleton in lines between endpoints and junctions
+    vector<vector<int>> lines;
+    vector<unsigned char> visited(skeleton.size(), 0);
+    int neighbours[8];
+    int next[8];
+
+    for (int index = 0; index < skeleton.size(); index++)
+    {
+        if (!skeleton[index] || Neighbours(raster, skeleton, index, neighbours) == 2)
+        {
+            continue;
+        }
+
+        for (int i = 0; i < 8; i++)
+        {
+            int start = neighbours[i];
+            if (start == -1 || visited[start])
+            {
+                continue;
+            }
+
+            vector<int> line = {index, start};
+            int previous = index;
+            int current = start;
+            // directly touching nodes
+            if (Neighbours(raster, skeleton, current, next) != 2)
+            {
+                if (index < current)
+                {
+                    lines.push_back(line);
+                }
+                continue;
+            }
+            while (Neighbours(raster, skeleton, current, next) == 2)
+            {
+                visited[current] = 1;
+                int following = next[0] != -1 && next[0] != previous ? next[0] : -1;
+                for (int k = 1; k < 8 && following == -1; k++)
+                {
+                    if (next[k] != -1 && next[k] != previous)
+                    {
+                        following = next[k];
+                    }
+                }
+                previous = current;
+                current = following;
+                line.push_back(current);
+            }
+            lines.push_back(line);
+        }
+    }
+
+    // closed loops do not have any endpoints or junctions
+    for (int index = 0; index < skeleton.size(); index++)
+    {
+        if (!skeleton[index] || visited[index])
+        {
+            continue;
+        }
+
+        vector<int> line = {index};
+        visited[index] = 1;
+        int previous = -1;
+        int current = index;
+        while (true)
+        {
+            Neighbours(raster, skeleton, current, next);
+            int following = -1;
+            for (int k = 0; k < 8 && following == -1; k++)
+            {
+                if (next[k] != -1 && next[k] != previous && !visited[next[k]])
+                {
+                    following = next[k];
+                }
+            }
+            if (following == -1)
+            {
+                break;
+            }
+            visited[following] = 1;
+            previous = current;
+            current = following;
+            line.push_back(current);
+        }
+        line.push_back(index);
+        lines.push_back(line);
+    }
+
+    return lines;
+}
+
+VariableWidthPath VariableWidthWalls::ToPath(Raster &raster, vector<int> &pixels)
+{
+    VariableWidthPath line;
+    for (int pixel : pixels)
+    {
+        int x = pixel % raster.width;
+        int y = pixel / raster.width;
+        line.path.push_back(Clipper2Lib::PointD(raster.left + (x + 0.5) * raster.pixelSize, raster.top + (y + 0.5) * raster.pixelSize));
+        line.widths.push_back(2 * raster.distance[pixel] * raster.pixelSize);
+    }
+
+    // smooth the pixel noise out of the widths
+    vector<double> smoothed(line.widths.size());
+    for (int i = 0; i < line.widths.size(); i++)
+    {
+        int from = max(0, i - 2);
+        int to = min((int)line.widths.size() - 1, i + 2);
+        double sum = 0;
+        for (int k = from; k <= to; k++)
+        {
+            sum += line.widths[k];
+        }
+        smoothed[i] = sum / (to - from + 1);
+    }
+    line.widths = smoothed;
+
+    return line;
+}
+
+void VariableWidthWalls::Simplify(VariableWidthPath &path, double tolerance)
+{
+    // Douglas-Peucker on (x, y, width), so changes in width are kept as well as changes in direction
+    vector<bool> keep(path.path.size(), false);
+    keep.front() = true;
+    keep.back() = true;
+    vector<pair<int, int>> stack = {{0, (int)path.path.size() - 1}};
+    while (stack.size() > 0)
+    {
+        pair<int, int> range = stack.back();
+        stack.pop_back();
+
+        Clipper2Lib::PointD a = path.path[range.first];
+        Clipper2Lib::PointD b = path.path[range.second];
+        double dx = b.x - a.x, dy = b.y - a.y, dw = path.widths[range.second] - path.widths[range.first];
+        double lengthSq = dx * dx + dy * dy + dw * dw;
+
+        double furthest = 0;
+        int index = -1;
+        for (int i = range.first + 1; i < range.second; i++)
+        {
+            Clipper2Lib::PointD p = path.path[i];
+            double t = lengthSq > 0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy + (path.widths[i] - path.widths[range.first]) * dw) / lengthSq : 0;
+            t = max(0.0, min(1.0, t));
+            double distance = sqrt(pow(a.x + t * dx - p.x, 2) + pow(a.y + t * dy - p.y, 2) + pow(path.widths[range.first] + t * dw - path.widths[i], 2));
+            if (distance > furthest)
+            {
+                furthest = distance;
+                index = i;
+            }
+        }
+
+        if (index != -1 && furthest > tolerance)
+        {
+            keep[index] = true;
+            stack.push_back({range.first, index});
+            stack.push_back({index, range.second});
+        }
+    }
+
+    VariableWidthPath simplified;
+    for (int i = 0; i < path.path.size(); i++)
+    {
+        if (keep[i])
+        {
+            simplified.path.push_back(path.path[i]);
+            simplified.widths.push_back(path.widths[i]);
+        }
+    }
+    path = simplified;
+}
+
+#endif
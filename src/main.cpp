@@ -24,13 +24,15 @@
 #include "Slicing/Infill/CreateInfill.hpp"
 #include <time.h>
 #include "PathOptimization/PathOptimization.hpp"
+#include "Scene/Scene.hpp"
+#include "Slicing/OutOfCore/SlabSlicer.hpp"
 #include <nfd.h>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow *window);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
-Model LoadSTL(const char* path, glm::vec3 &translation);
+Model LoadSTL(const char* path);
 
 // initial window dimensions
 unsigned int SCR_WIDTH = 1980;
@@ -121,21 +123,8 @@ int main()
 
     SlicingPlane slicingPlane = SlicingPlane(slicingPlaneShader);
 
-    // load models
-    // -----------
-    Model ourModel("other/hello.stl");
-
-    // move vertices up by lowest point
-    float lowest = DrawSTL::GetLowestPoint(ourModel);
-    glm::vec3 center = DrawSTL::GetXYCenterPoint(ourModel);
-    for (int i = 0; i < ourModel.meshes[0].vertices.size(); i++)
-    {
-        ourModel.meshes[0].vertices[i].Position.z -= lowest;
-        ourModel.meshes[0].vertices[i].Position.x -= center.x;
-        ourModel.meshes[0].vertices[i].Position.y -= center.y;
-    }
-
-    glm::vec3 translation = glm::vec3(center.x, center.y, lowest);
+    // models are added to the scene when they are loaded
+    Scene scene;
 
     Intersection intersection = Intersection();
 
@@ -202,7 +191,7 @@ int main()
 
         //object
         if (modelLoaded)
-            DrawSTL::Draw(objectShader, ourModel, view, projection, camera, translation);
+            scene.Draw(objectShader, view, projection, camera);
 
         //slice plane (draw last because it is transparent)
         float height = intersection.GetSlicingPlaneHeight(slicerSettings.GetLayerHeight());
@@ -262,7 +251,7 @@ int main()
                 if (result == NFD_OKAY)
                 {
                     puts("Success!");
-                    ourModel = LoadSTL(outPath, translation);
+                    scene.AddObject(LoadSTL(outPath));
                     NFD_FreePathU8(outPath);
                 }
                 else if (result == NFD_CANCEL)
@@ -275,6 +264,114 @@ int main()
                 }
             }
 
+            // files too large to load are sliced straight from disk, slab by slab, they are not shown in the scene
+            if (ImGui::Button("Slice large STL")) {
+                nfdu8char_t *largePath;
+                nfdu8filteritem_t largeFilters[1] = { { "STL file", "stl" } };
+                nfdopendialogu8args_t largeArgs = {0};
+                largeArgs.filterList = largeFilters;
+                largeArgs.filterCount = 1;
+                if (NFD_OpenDialogU8_With(&largePath, &largeArgs) == NFD_OKAY)
+                {
+                    vector<Slice> sliceMap;
+                    if (!SlabSlicer::SliceFile(largePath, slicerSettings, sliceMap))
+                        printf("Could not read %s as an STL file.\n", largePath);
+                    NFD_FreePathU8(largePath);
+                    PathOptimization optimizer(sliceMap, slicerSettings.GetSeamMode(), slicerSettings.GetNozzleDiameter(), slicerSettings.GetMonotonicSurface());
+                    optimizer.OptimizePaths();
+                    vector<Slice> optimizedSlices = optimizer.GetSlices();
+                    intersection.SetSliceMap(optimizedSlices);
+                }
+            }
+
+            int slabLayers = slicerSettings.GetSlabLayers();
+            if (ImGui::InputInt("Layers per slab", &slabLayers, 8, 32))
+                slicerSettings.SetSlabLayers(max(1, slabLayers));
+
+            // every object on the plate with its instances
+            vector<SceneObject> &sceneObjects = scene.GetObjects();
+            for (int o = 0; o < sceneObjects.size(); o++)
+            {
+                ImGui::PushID(o);
+                ImGui::Text("Object %d", o + 1);
+                ImGui::SameLine();
+                if (ImGui::Button("Add instance"))
+                    scene.AddInstance(o);
+                ImGui::SameLine();
+                if (ImGui::Button("Orient"))
+                    scene.OrientObject(o, slicerSettings);
+
+                // modifiers change the settings of the part of the object inside them
+                if (ImGui::Button("Add box modifier"))
+                    scene.AddModifier(o, Modifiers::Box(glm::vec3(20.0f)), slicerSettings);
+                ImGui::SameLine();
+                if (ImGui::Button("Add cylinder modifier"))
+                    scene.AddModifier(o, Modifiers::Cylinder(10.0f, 20.0f), slicerSettings);
+                ImGui::SameLine();
+                if (ImGui::Button("Load modifier")) {
+                    nfdu8char_t *modifierPath;
+                    nfdu8filteritem_t modifierFilters[1] = { { "STL file", "stl" } };
+                    nfdopendialogu8args_t modifierArgs = {0};
+                    modifierArgs.filterList = modifierFilters;
+                    modifierArgs.filterCount = 1;
+                    if (NFD_OpenDialogU8_With(&modifierPath, &modifierArgs) == NFD_OKAY)
+                    {
+                        scene.AddModifier(o, LoadSTL(modifierPath).meshes[0].vertices, slicerSettings);
+                        NFD_FreePathU8(modifierPath);
+                    }
+                }
+
+                for (int m = 0; m < sceneObjects[o].modifiers.size(); m++)
+                {
+                    ImGui::PushID(1000 + m);
+                    Modifier &modifier = sceneObjects[o].modifiers[m];
+                    ImGui::Text("Modifier %d", m + 1);
+                    // the translation of the transform, the modifier moves with the object
+                    ImGui::InputFloat3("Position", &modifier.transform[3][0], "%.1f mm");
+                    if (ImGui::InputInt("Shells", &modifier.shells, 1, 1))
+                        modifier.shells = max(0, modifier.shells);
+                    if (ImGui::InputFloat("Infill", &modifier.infill, 5.0f, 10.0f, "%.1f pct"))
+                        modifier.infill = min(100.0f, max(0.0f, modifier.infill));
+                    if (ImGui::InputInt("Roofs and floors", &modifier.surfaces, 1, 1))
+                        modifier.surfaces = max(0, modifier.surfaces);
+                    if (ImGui::Button("Remove modifier"))
+                    {
+                        scene.RemoveModifier(o, m);
+                        ImGui::PopID();
+                        break;
+                    }
+                    ImGui::PopID();
+                }
+
+                bool removed = false;
+                for (int k = 0; !removed && k < sceneObjects[o].placements.size(); k++)
+                {
+                    ImGui::PushID(k);
+                    Placement &placement = sceneObjects[o].placements[k];
+                    ImGui::InputDouble("X", &placement.x, 1.0, 10.0, "%.1f mm");
+                    ImGui::InputDouble("Y", &placement.y, 1.0, 10.0, "%.1f mm");
+                    ImGui::InputDouble("Rotation", &placement.rotation, 5.0, 45.0, "%.0f deg");
+                    if (ImGui::Button("Remove instance"))
+                    {
+                        scene.RemoveInstance(o, k);
+                        removed = true;
+                    }
+                    ImGui::PopID();
+                }
+                ImGui::PopID();
+                if (removed)
+                    break;
+            }
+
+            float arrangeSpacing = slicerSettings.GetArrangeSpacing();
+            if (ImGui::InputFloat("Arrange spacing", &arrangeSpacing, 0.5f, 1.0f, "%.1f mm"))
+                slicerSettings.SetArrangeSpacing(max(0.0f, arrangeSpacing));
+
+            if (ImGui::Button("Arrange")) {
+                int unplaced = scene.ArrangePlate(slicerSettings);
+                if (unplaced > 0)
+                    printf("%d instances do not fit on the plate.\n", unplaced);
+            }
 
             float printSpeed = gcodeWriter.GetPrintSpeed();
             float bedTemperature = gcodeWriter.GetBedTemp();
@@ -320,6 +417,117 @@ int main()
             if(ImGui::InputFloat("Infill percentage", &infillPercentage, 0.5f, 1.0f, "%.1f pct"))
                 slicerSettings.SetInfill(infillPercentage);
 
+            int infillType = (int)slicerSettings.GetInfillType();
+            if (ImGui::Combo("Infill pattern", &infillType, "Diagonal\0Honeycomb\0Triangles\0"))
+                slicerSettings.SetInfillType((InfillType)infillType);
+
+            bool connectInfill = slicerSettings.GetConnectInfill();
+            if (ImGui::Checkbox("Connect infill lines", &connectInfill))
+                slicerSettings.SetConnectInfill(connectInfill);
+
+            bool monotonicSurface = slicerSettings.GetMonotonicSurface();
+            if (ImGui::Checkbox("Monotonic surfaces", &monotonicSurface))
+                slicerSettings.SetMonotonicSurface(monotonicSurface);
+
+            bool variableWidthWalls = slicerSettings.GetVariableWidthWalls();
+            if (ImGui::Checkbox("Variable width thin walls", &variableWidthWalls))
+                slicerSettings.SetVariableWidthWalls(variableWidthWalls);
+
+            bool gapFill = slicerSettings.GetGapFill();
+            if (ImGui::Checkbox("Fill gaps between walls", &gapFill))
+                slicerSettings.SetGapFill(gapFill);
+
+            if (slicerSettings.GetGapFill())
+            {
+                float gapFillSpeed = slicerSettings.GetGapFillSpeed();
+                if (ImGui::InputFloat("Gap fill speed", &gapFillSpeed, 1.0f, 5.0f, "%.0f mm/s"))
+                    slicerSettings.SetGapFillSpeed(max(1.0f, gapFillSpeed));
+
+                float gapFillFlow = slicerSettings.GetGapFillFlow();
+                if (ImGui::InputFloat("Gap fill flow", &gapFillFlow, 1.0f, 5.0f, "%.0f pct"))
+                    slicerSettings.SetGapFillFlow(max(1.0f, gapFillFlow));
+            }
+
+            bool bridges = slicerSettings.GetBridges();
+            if (ImGui::Checkbox("Detect bridges", &bridges))
+                slicerSettings.SetBridges(bridges);
+
+            if (slicerSettings.GetBridges())
+            {
+                float bridgeSpeed = slicerSettings.GetBridgeSpeed();
+                if (ImGui::InputFloat("Bridge speed", &bridgeSpeed, 1.0f, 5.0f, "%.0f mm/s"))
+                    slicerSettings.SetBridgeSpeed(max(1.0f, bridgeSpeed));
+
+                float bridgeFlow = slicerSettings.GetBridgeFlow();
+                if (ImGui::InputFloat("Bridge flow", &bridgeFlow, 1.0f, 5.0f, "%.0f pct"))
+                    slicerSettings.SetBridgeFlow(max(1.0f, bridgeFlow));
+            }
+
+            bool ironing = slicerSettings.GetIroning();
+            if (ImGui::Checkbox("Iron top surfaces", &ironing))
+                slicerSettings.SetIroning(ironing);
+
+            if (slicerSettings.GetIroning())
+            {
+                float ironingSpeed = slicerSettings.GetIroningSpeed();
+                if (ImGui::InputFloat("Ironing speed", &ironingSpeed, 1.0f, 5.0f, "%.0f mm/s"))
+                    slicerSettings.SetIroningSpeed(max(1.0f, ironingSpeed));
+
+                float ironingFlow = slicerSettings.GetIroningFlow();
+                if (ImGui::InputFloat("Ironing flow", &ironingFlow, 1.0f, 5.0f, "%.0f pct"))
+                    slicerSettings.SetIroningFlow(max(0.0f, ironingFlow));
+            }
+
+            bool supports = slicerSettings.GetSupports();
+            if (ImGui::Checkbox("Generate supports", &supports))
+                slicerSettings.SetSupports(supports);
+
+            if (slicerSettings.GetSupports())
+            {
+                int supportType = (int)slicerSettings.GetSupportType();
+                if (ImGui::Combo("Support type", &supportType, "Normal\0Tree\0"))
+                    slicerSettings.SetSupportType((SupportType)supportType);
+
+                float supportAngle = slicerSettings.GetSupportAngle();
+                if (ImGui::InputFloat("Support overhang angle", &supportAngle, 1.0f, 5.0f, "%.0f deg"))
+                    slicerSettings.SetSupportAngle(min(89.0f, max(0.0f, supportAngle)));
+
+                float supportDensity = slicerSettings.GetSupportDensity();
+                if (ImGui::InputFloat("Support density", &supportDensity, 1.0f, 5.0f, "%.0f pct"))
+                    slicerSettings.SetSupportDensity(min(100.0f, max(1.0f, supportDensity)));
+
+                int supportInterfaceLayers = slicerSettings.GetSupportInterfaceLayers();
+                if (ImGui::InputInt("Support interface layers", &supportInterfaceLayers, 1, 1))
+                    slicerSettings.SetSupportInterfaceLayers(max(0, supportInterfaceLayers));
+            }
+
+            float maxDeviation = slicerSettings.GetMaxDeviation();
+            if (ImGui::InputFloat("Maximum deviation", &maxDeviation, 0.005f, 0.01f, "%.3f mm"))
+                slicerSettings.SetMaxDeviation(max(0.0f, maxDeviation));
+
+            float minSegmentLength = slicerSettings.GetMinSegmentLength();
+            if (ImGui::InputFloat("Minimum segment length", &minSegmentLength, 0.05f, 0.1f, "%.2f mm"))
+                slicerSettings.SetMinSegmentLength(max(0.0f, minSegmentLength));
+
+            int seamMode = (int)slicerSettings.GetSeamMode();
+            if (ImGui::Combo("Z seam", &seamMode, "Aligned\0Nearest\0Rear\0"))
+                slicerSettings.SetSeamMode((SeamMode)seamMode);
+
+            int combineInfill = slicerSettings.GetCombineInfill();
+            if (ImGui::InputInt("Combine infill every n layers", &combineInfill, 1, 1))
+                slicerSettings.SetCombineInfill(max(1, combineInfill));
+
+            int gradualInfillSteps = slicerSettings.GetGradualInfillSteps();
+            if (ImGui::InputInt("Gradual infill steps", &gradualInfillSteps, 1, 1))
+                slicerSettings.SetGradualInfillSteps(max(0, gradualInfillSteps));
+
+            if (slicerSettings.GetGradualInfillSteps() > 0)
+            {
+                int gradualInfillStepLayers = slicerSettings.GetGradualInfillStepLayers();
+                if (ImGui::InputInt("Gradual infill step layers", &gradualInfillStepLayers, 1, 1))
+                    slicerSettings.SetGradualInfillStepLayers(max(1, gradualInfillStepLayers));
+            }
+
             Skirt skirt = slicerSettings.GetSkirt();
             if (ImGui::Checkbox("Enable skirt", &skirt.enabled))
 				slicerSettings.SetSkirt(skirt);
@@ -335,6 +543,50 @@ int main()
                 if (ImGui::InputDouble("Skirt distance", &skirt.distance, 0.1, 1.0, "%.2f mm"))
                     slicerSettings.SetSkirt(skirt);
 			}
+
+            Brim brim = slicerSettings.GetBrim();
+            if (ImGui::Checkbox("Enable brim", &brim.enabled))
+                slicerSettings.SetBrim(brim);
+
+            if (brim.enabled)
+            {
+                if (ImGui::InputInt("Brim lines", &brim.lines, 1, 1))
+                {
+                    brim.lines = max(1, brim.lines);
+                    slicerSettings.SetBrim(brim);
+                }
+            }
+
+            Raft raft = slicerSettings.GetRaft();
+            if (ImGui::Checkbox("Enable raft", &raft.enabled))
+                slicerSettings.SetRaft(raft);
+
+            if (raft.enabled)
+            {
+                if (ImGui::InputInt("Raft base layers", &raft.baseLayers, 1, 1))
+                {
+                    raft.baseLayers = max(0, raft.baseLayers);
+                    slicerSettings.SetRaft(raft);
+                }
+
+                if (ImGui::InputInt("Raft interface layers", &raft.interfaceLayers, 1, 1))
+                {
+                    raft.interfaceLayers = max(0, raft.interfaceLayers);
+                    slicerSettings.SetRaft(raft);
+                }
+
+                if (ImGui::InputInt("Raft surface layers", &raft.surfaceLayers, 1, 1))
+                {
+                    raft.surfaceLayers = max(0, raft.surfaceLayers);
+                    slicerSettings.SetRaft(raft);
+                }
+
+                if (ImGui::InputDouble("Raft margin", &raft.margin, 0.5, 1.0, "%.1f mm"))
+                {
+                    raft.margin = max(0.0, raft.margin);
+                    slicerSettings.SetRaft(raft);
+                }
+            }
             
             
 
@@ -342,11 +594,12 @@ int main()
             if (ImGui::Button("Slice")) {
                 time_t start, end;
                 time(&start);
-                vector<Slice> sliceMap = Slicing::SliceModel(ourModel.meshes[0].vertices, slicerSettings);
+                vector<PlateObject> plateObjects = scene.GetPlateObjects();
+                vector<Slice> sliceMap = Plate::SlicePlate(plateObjects, slicerSettings);
                 time(&end);
                 double dif = difftime(end, start);
                 printf("Elapsed time is %.2lf seconds.\n", dif);
-                PathOptimization optimizer(sliceMap);
+                PathOptimization optimizer(sliceMap, slicerSettings.GetSeamMode(), slicerSettings.GetNozzleDiameter(), slicerSettings.GetMonotonicSurface());
                 optimizer.OptimizePaths();
                 vector<Slice> optimizedSlices = optimizer.GetSlices();
                 intersection.SetSliceMap(optimizedSlices);
@@ -513,20 +766,10 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
         camera.ProcessMouseScroll(static_cast<float>(yoffset));
 }
 
-Model LoadSTL(const char* path, glm::vec3& translation)
+Model LoadSTL(const char* path)
 {
+    // the model is kept as it was loaded, the scene puts it on the bed with a transform
     Model ourModel(path);
-    // move vertices up by lowest point
-    float lowest = DrawSTL::GetLowestPoint(ourModel);
-    glm::vec3 center = DrawSTL::GetXYCenterPoint(ourModel);
-    for (int i = 0; i < ourModel.meshes[0].vertices.size(); i++)
-    {
-        ourModel.meshes[0].vertices[i].Position.z -= lowest;
-        ourModel.meshes[0].vertices[i].Position.x -= center.x;
-        ourModel.meshes[0].vertices[i].Position.y -= center.y;
-    }
-
-    translation = glm::vec3(center.x, center.y, lowest);
     modelLoaded = true;
     return ourModel;
-}
\ No newline at end of file
+}